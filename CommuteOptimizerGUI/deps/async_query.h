@@ -0,0 +1,197 @@
+#ifndef ASYNC_QUERY_H
+#define ASYNC_QUERY_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <chrono>
+#include "search_stats.h"
+#include "trace.h"
+
+using namespace std;
+
+struct MapLayout;
+
+// What a finished job hands back to the frame
+struct QueryResult {
+    string text;                    // Shown in the route details panel
+    vector<vector<int>> routes;     // Stops of each route found, best first, for the map
+    SearchStats stats;              // Instrumentation of the search, if it was collected
+    shared_ptr<const MapLayout> map_layout;   // Set by map layout jobs
+
+    QueryResult(const string& t = "") : text(t) {}
+};
+
+// Thrown out of a search whose query was cancelled or replaced while it ran
+struct QueryCancelled {};
+
+// One background thread for the GUI. Route searches and map edits run here and hand their
+// result back through a future, so the render loop only polls and never waits.
+//
+// Queries are "latest wins": submitting one, or calling cancelQueries(), drops every query still
+// waiting in the queue and bumps the query generation. A search already running notices the new
+// generation through CancellableSearchStats and gives up, so edits and newer queries do not wait
+// behind an answer nobody will read. Edits are never dropped and run in submission order,
+// interleaved with queries as they were submitted. Background jobs, such as laying out the
+// network map, are neither dropped by queries nor drop them.
+class QueryRunner {
+private:
+    enum JobKind { JOB_QUERY, JOB_EDIT, JOB_BACKGROUND };
+
+    struct Job {
+        JobKind kind;
+        unsigned long long generation = 0;  // Queries: the generation they belong to
+        function<QueryResult()> work;
+        promise<QueryResult> result;
+    };
+
+    // The query running on the calling thread; empty on every thread but the worker's
+    struct RunningQuery {
+        const atomic<unsigned long long>* generation = nullptr;
+        unsigned long long own = 0;
+    };
+
+    static RunningQuery& runningQuery() {
+        static thread_local RunningQuery running;
+        return running;
+    }
+
+    mutex queue_mutex;
+    condition_variable wake;
+    deque<Job> jobs;
+    bool stopping = false;
+    atomic<unsigned long long> query_generation{0};   // Bumped by every new query and every cancel
+    thread worker;              // Declared last so everything above exists when it starts
+
+    void run() {
+        Tracer::setThreadName("QueryRunner");
+        while (true) {
+            Job job;
+            {
+                unique_lock<mutex> lock(queue_mutex);
+                wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty()) return; // Stopping, and the edits left behind have run
+                job = move(jobs.front());
+                jobs.pop_front();
+            }
+            if (job.kind == JOB_QUERY) {
+                runningQuery().generation = &query_generation;
+                runningQuery().own = job.generation;
+            }
+            try {
+                TraceSpan span(job.kind == JOB_QUERY ? "query job" : job.kind == JOB_EDIT ? "edit job" : "background job", "gui");
+                job.result.set_value(job.work());
+            } catch (const QueryCancelled&) {
+                job.result.set_value(QueryResult("Query cancelled."));
+            } catch (const exception& e) {
+                job.result.set_value(QueryResult(string("Error: ") + e.what()));
+            }
+            runningQuery() = RunningQuery();
+        }
+    }
+
+    future<QueryResult> submit(JobKind kind, function<QueryResult()> work) {
+        Job job;
+        job.kind = kind;
+        job.work = move(work);
+        future<QueryResult> result = job.result.get_future();
+        {
+            lock_guard<mutex> lock(queue_mutex);
+            if (kind == JOB_QUERY) {
+                dropWaitingQueries();
+                job.generation = ++query_generation;
+            }
+            jobs.push_back(move(job));
+        }
+        wake.notify_one();
+        return result;
+    }
+
+    // Caller holds queue_mutex
+    void dropWaitingQueries() {
+        for (auto it = jobs.begin(); it != jobs.end();) {
+            it = it->kind == JOB_QUERY ? jobs.erase(it) : it + 1;
+        }
+    }
+
+public:
+    QueryRunner() : worker(&QueryRunner::run, this) {}
+
+    QueryRunner(const QueryRunner&) = delete;
+    QueryRunner& operator=(const QueryRunner&) = delete;
+
+    // Waiting edits still run so nothing the user added is lost; other waiting jobs are abandoned,
+    // a running query is cancelled and any other running job is allowed to finish
+    ~QueryRunner() {
+        {
+            lock_guard<mutex> lock(queue_mutex);
+            stopping = true;
+            query_generation++;
+            for (auto it = jobs.begin(); it != jobs.end();) {
+                it = it->kind != JOB_EDIT ? jobs.erase(it) : it + 1;
+            }
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    // Replaces any query that has not started yet
+    future<QueryResult> submitQuery(function<QueryResult()> work) { return submit(JOB_QUERY, move(work)); }
+
+    future<QueryResult> submitEdit(function<QueryResult()> work) { return submit(JOB_EDIT, move(work)); }
+
+    future<QueryResult> submitBackground(function<QueryResult()> work) { return submit(JOB_BACKGROUND, move(work)); }
+
+    // Forget queries that have not started and cancel the running one; the caller drops its future
+    void cancelQueries() {
+        lock_guard<mutex> lock(queue_mutex);
+        dropWaitingQueries();
+        query_generation++;
+    }
+
+    // Throws QueryCancelled when called from a query whose generation has been superseded.
+    // A no-op on any other thread and in edit and background jobs.
+    static void throwIfCancelled() {
+        const RunningQuery& running = runningQuery();
+        if (running.generation && running.generation->load(memory_order_relaxed) != running.own) {
+            throw QueryCancelled();
+        }
+    }
+};
+
+// Stats policy for searches run as QueryRunner queries. Every CHECK_INTERVAL hook calls it asks
+// whether the query is still wanted and, if not, throws QueryCancelled out of the engine. Engines
+// hold their state in locals or reset it when a search starts, so they are safe to leave this way.
+template <class Base>
+class CancellableSearchStats : public Base {
+private:
+    static const unsigned CHECK_INTERVAL = 1024;
+    unsigned until_check = CHECK_INTERVAL;
+
+    void tick() {
+        if (--until_check == 0) {
+            until_check = CHECK_INTERVAL;
+            QueryRunner::throwIfCancelled();
+        }
+    }
+
+public:
+    void settled() { Base::settled(); tick(); }
+    void relaxed() { Base::relaxed(); tick(); }
+    void popped() { Base::popped(); tick(); }
+};
+
+// True once the future holds an answer; never blocks
+inline bool isReady(const future<QueryResult>& result) {
+    return result.valid() && result.wait_for(chrono::seconds(0)) == future_status::ready;
+}
+
+#endif // ASYNC_QUERY_H
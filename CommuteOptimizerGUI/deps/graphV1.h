@@ -1,345 +1,589 @@
-#ifndef GRAPH_H
-#define GRAPH_H
-
-#include <algorithm>
-#include <vector>
-#include <list>
-#include <string>
-#include <unordered_map> // Keep for potential future name-to-ID mapping
-#include <iostream>
-#include <iomanip>
-#include <limits>     // For std::numeric_limits
-#include <fstream>    // Keep if you plan to load graph from file
-#include <queue>
-#include <sstream>    // Keep for potential string parsing
-#include <stack>
-
-// Using namespace std for convenience in this project file
-using namespace std;
-
-void clearInputBuffer() {
-    cin.clear();
-    cin.ignore(numeric_limits<streamsize>::max(), '\n');
-}
-
-// Define INF constants
-const double DOUBLE_INF = std::numeric_limits<double>::infinity();
-const int INT_INF = std::numeric_limits<int>::max();
-
-// Forward declarations (if Node/Edge were more complex or in separate files)
-// class Node;
-// class Edge;
-
-// Edge class representing a route between two nodes
-class Edge {
-public:
-    int destination_node_id; // Renamed for clarity
-    double weight;           // Distance or time between nodes
-
-    Edge(int dest_id, double w) : destination_node_id(dest_id), weight(w) {}
-};
-
-// Node class representing a bus stop
-class Node {
-public:
-    int id;
-    string name;
-    list<Edge> edges;    // List of edges connected to this node
-
-    // Default constructor
-    Node() : id(-1), name("") {}
-
-    // Parameterized constructor
-    Node(int nodeId, const string& nodeName = "")
-        : id(nodeId), name(nodeName){}
-};
-
-
-
-// Struct to hold pathfinding results
-struct PathDetails {
-    double total_weight = DOUBLE_INF;    // For Dijkstra's (e.g., distance, time)
-    int num_stops = -1;                  // For BFS (number of segments/edges in path)
-                                         // -1 or INT_INF can indicate no path or not applicable
-    vector<int> node_ids_in_path;
-    bool path_exists = false;
-
-    // Default constructor
-    PathDetails() = default;
-};
-
-
-// Graph class using adjacency list representation
-class Graph {
-public:
-    vector<Node> nodes_list; // Renamed for clarity to avoid conflict with a 'nodes' variable name
-    int numNodes;
-    // Constructor
-    Graph(int n = 0) : numNodes(n) {
-        nodes_list.resize(n);
-        for (int i = 0; i < n; i++) {
-            // Initialize with basic Node object, ID will be set by addNode or directly
-            nodes_list[i].id = i;
-        }
-    }
-
-    // Add a node to the graph (or update if exists)
-    void addNode(int id, const string& name = "") {
-        if (id >= numNodes) {
-            // Resize if ID is out of current bounds, new nodes will be default constructed
-            // Ensure new nodes get their ID set if this strategy is used extensively.
-            nodes_list.resize(id + 1);
-            for(int i = numNodes; i <= id; ++i) {
-                nodes_list[i].id = i; // Explicitly set ID for new default nodes
-            }
-            numNodes = id + 1;
-        }
-        // Now update the node at 'id'
-        nodes_list[id] = Node(id, name);
-    }
-
-    // Add an edge between two nodes (undirected)
-    void addEdge(int source_id, int destination_id, double weight) {
-        if (source_id >= numNodes || destination_id >= numNodes || source_id < 0 || destination_id < 0) {
-            throw out_of_range("addEdge: Node index out of bounds. Ensure nodes are added before edges.");
-        }
-
-        nodes_list[source_id].edges.push_back(Edge(destination_id, weight));
-        nodes_list[destination_id].edges.push_back(Edge(source_id, weight)); // Assuming undirected
-    }
-
-    // Get the number of nodes
-    int getNumNodes() const { return numNodes; }
-
-    // Get a node by its ID (const reference)
-    const Node& getNode(int id) const {
-        if (id >= numNodes || id < 0) {
-            throw out_of_range("getNode: Node index out of bounds");
-        }
-        return nodes_list[id];
-    }
-
-    // NOT USED:: Get a node by its ID (non-const reference - use with caution, e.g. for internal graph building)
-    Node& getNodeByIdNonConst(int id) {
-        if (id >= numNodes || id < 0) {
-            throw out_of_range("getNodeByIdNonConst: Node index out of bounds");
-        }
-        return nodes_list[id];
-    }
-
-    int getNodeIndexByname(string const& name) {
-        for (int i = 0; i < numNodes; i++) {
-            if (nodes_list[i].name == name) {
-                return i;
-            }
-        }
-        return -1;
-    }
-
-    // Get all edges of a node
-    const list<Edge>& getEdges(int nodeId) const {
-        if (nodeId >= numNodes || nodeId < 0) {
-            throw out_of_range("getEdges: Node index out of bounds");
-        }
-        return nodes_list[nodeId].edges;
-    }
-
-    // Print the graph structure
-    void printGraph() const {
-        cout << "\n--- Graph Structure ---" << endl;
-        for (int i = 0; i < numNodes; i++) {
-            cout << "Node " << nodes_list[i].id;
-            if (!nodes_list[i].name.empty()) {
-                cout << " (" << nodes_list[i].name << ")";
-            }
-
-            if (nodes_list[i].edges.empty()) {
-                cout << "None";
-            } else {
-                for (const Edge& edge : nodes_list[i].edges) {
-                    cout << edge.destination_node_id << "(" << fixed << setprecision(1) << edge.weight << ") ";
-                }
-            }
-            cout << endl;
-        }
-        cout << "-----------------------\n" << endl;
-    }
-
-    // Create the adjacency matrix (Commented out as not essential for core Dijkstra/BFS with adjacency lists)
-    typedef vector<vector<double>> AdjacencyMatrix;
-    AdjacencyMatrix createAdjacencyMatrix() const {
-        vector<vector<double>> matrix(numNodes, vector<double>(numNodes, DOUBLE_INF));
-
-        for (int i = 0; i < numNodes; ++i) {
-            matrix[i][i] = 0.0; // Distance to self is 0
-        }
-
-        for (int i = 0; i < numNodes; i++) {
-            for (const Edge& edge : nodes_list[i].edges) {
-                matrix[i][edge.destination_node_id] = edge.weight;
-            }
-        }
-        return matrix;
-    }
-
-    // Print the adjacency matrix (Commented out)
-    void printAdjacencyMatrix() const {
-        vector<vector<double>> matrix = createAdjacencyMatrix();
-
-        cout << "\nAdjacency Matrix (distances between stops):\n";
-        cout << setw(6) << " "; // Adjusted for node names potentially
-        for (int i = 0; i < numNodes; i++) {
-            cout << setw(8) << nodes_list[i].name.substr(0,7) ; // Print part of name
-        }
-        cout << "\n";
-
-        for (int i = 0; i < numNodes; i++) {
-            cout << setw(5) << nodes_list[i].name.substr(0,4) << " |";
-            for (int j = 0; j < numNodes; j++) {
-                if (matrix[i][j] == DOUBLE_INF) {
-                    cout << setw(8) << "INF";
-                } else {
-                    cout << setw(8) << fixed << setprecision(1) << matrix[i][j];
-                }
-            }
-            cout << "\n";
-        }
-        cout << endl;
-    }
-
-    PathDetails Dijkstra(int startNodeId, int endNodeId) {
-        PathDetails result;
-        result.path_exists = false;
-
-        if (startNodeId >= numNodes || endNodeId >= numNodes || startNodeId < 0 || endNodeId < 0) {
-            cerr << "Error: Invalid start or end node ID in Dijkstra." << endl;
-            return result;
-        }
-
-        if (startNodeId == endNodeId) {
-            result.path_exists = true;
-            result.node_ids_in_path.push_back(startNodeId);
-            result.num_stops = 0;
-            // Total_weight can remain DOUBLE_INF or be set to 0.0 as it's 0 stops.
-            // For consistency, if a path to self exists, weight is 0.
-            result.total_weight = 0.0;
-            return result;
-        }
-
-        vector<double> distances(numNodes, DOUBLE_INF);
-        vector<int> previous(numNodes, -1);
-        vector<bool> visited(numNodes, false);
-
-        distances[startNodeId] = 0;
-
-        priority_queue<pair<double, int>, vector<pair<double, int>>, greater<pair<double, int>>> pq;
-        pq.push({0.0, startNodeId});
-
-        while (!pq.empty()) {
-            double removed_distance = pq.top().first; // Renamed for clarity
-            int removed_node_id = pq.top().second;
-            pq.pop();
-            visited[removed_node_id] = true;
-            for (const Edge& edge : nodes_list[removed_node_id].edges) {
-                if (visited[edge.destination_node_id]) {
-                    continue;
-                }
-                double new_distance = removed_distance + edge.weight;
-                if (new_distance < distances[edge.destination_node_id]) {
-                    distances[edge.destination_node_id] = new_distance;
-                    previous[edge.destination_node_id] = removed_node_id;
-                    pq.push({new_distance, edge.destination_node_id});
-                }
-            }
-        }
-        // Path Reconstruction (remains the same as before)
-        if (distances[endNodeId] != DOUBLE_INF) {
-            result.path_exists = true;
-            result.total_weight = distances[endNodeId];
-
-            stack<int> path_stack;
-            int current_node_id = endNodeId;
-            while (current_node_id != -1) {
-                path_stack.push(current_node_id);
-                current_node_id = previous[current_node_id];
-            }
-            while (!path_stack.empty()) {
-                result.node_ids_in_path.push_back(path_stack.top());
-                path_stack.pop();
-            }
-            result.num_stops = static_cast<int>(result.node_ids_in_path.size()) - 1;
-        }
-        return result;
-    }
-
-    PathDetails BFS(int startNodeId, int endNodeId) {
-        PathDetails result;
-        result.path_exists = false; // Assume no path initially
-        // Default: num_stops = -1, total_weight = DOUBLE_INF
-
-        // Error Handling
-        if (startNodeId >= numNodes || endNodeId >= numNodes || startNodeId < 0 || endNodeId < 0) {
-            cerr << "Error: Invalid start or end node ID in BFS." << endl; // Optional
-            return result;
-        }
-
-        // Error Handling
-        if (startNodeId == endNodeId) {
-            result.path_exists = true;
-            result.node_ids_in_path.push_back(startNodeId);
-            result.num_stops = 0;
-            result.total_weight = 0.0;
-            return result;
-        }
-
-        // Start of BFS
-        queue<int> q;
-        q.push(startNodeId);
-
-        vector<bool> visited(numNodes, false);
-        visited[startNodeId] = true;
-
-        vector<int> prev(numNodes, -1);
-
-        bool path_found_to_end_node = false; // Flag to indicate if endNodeId was reached
-
-        while (!q.empty()) {
-            int u_node_id = q.front();
-            q.pop();
-
-            if (u_node_id == endNodeId) {
-                path_found_to_end_node = true;
-                break;
-            }
-
-            // Explore neighbors
-            for (const Edge& edge : nodes_list[u_node_id].edges) {
-                int v_node_id = edge.destination_node_id;
-                if (!visited[v_node_id]) {
-                    visited[v_node_id] = true;
-                    prev[v_node_id] = u_node_id;
-                    q.push(v_node_id);
-                }
-            }
-        }
-
-        // Reconstruct path if the end node was reached
-        if (path_found_to_end_node) {
-            stack<int> path_stack;
-            int current_node_id = endNodeId;
-            while (current_node_id != -1) {
-                path_stack.push(current_node_id);
-                current_node_id = prev[current_node_id];
-            }
-            result.path_exists = true;
-            while (!path_stack.empty()) {
-                result.node_ids_in_path.push_back(path_stack.top());
-                path_stack.pop();
-            }
-            result.num_stops = static_cast<int>(result.node_ids_in_path.size()) - 1;
-        }
-        return result;
-    }
-};
-
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <unordered_map> // Keep for potential future name-to-ID mapping
+#include <iostream>
+#include <iomanip>
+#include <limits>     // For std::numeric_limits
+#include <fstream>    // Keep if you plan to load graph from file
+#include <queue>
+#include <sstream>    // Keep for potential string parsing
+#include <string_view>
+#include <cstdint>
+#include "name_arena.h"
+#include "name_index.h"
+#include "search_stats.h"
+#include "trace.h"
+
+// Using namespace std for convenience in this project file
+using namespace std;
+
+void clearInputBuffer() {
+    cin.clear();
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+}
+
+// Define INF constants
+const double DOUBLE_INF = std::numeric_limits<double>::infinity();
+const int INT_INF = std::numeric_limits<int>::max();
+
+// Forward declarations (if Node/Edge were more complex or in separate files)
+// class Node;
+// class Edge;
+
+// Edge class representing a route between two nodes, in the ID and weight types of its graph
+template <class Id, class Weight>
+class BasicEdge {
+public:
+    Id destination_node_id; // Renamed for clarity
+    Weight weight;          // Distance or time between nodes
+
+    BasicEdge() : destination_node_id(static_cast<Id>(-1)), weight(0) {}
+    BasicEdge(Id dest_id, Weight w) : destination_node_id(dest_id), weight(w) {}
+};
+typedef BasicEdge<int, double> Edge;
+
+// A node's edges: a contiguous slice of the graph's edge pool.
+// Adding edges may move the pool, so do not keep a range across addEdge.
+template <class Id, class Weight>
+class BasicEdgeRange {
+private:
+    const BasicEdge<Id, Weight>* first;
+    const BasicEdge<Id, Weight>* last;
+
+public:
+    BasicEdgeRange() : first(nullptr), last(nullptr) {}
+    BasicEdgeRange(const BasicEdge<Id, Weight>* begin, const BasicEdge<Id, Weight>* end) : first(begin), last(end) {}
+
+    const BasicEdge<Id, Weight>* begin() const { return first; }
+    const BasicEdge<Id, Weight>* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+};
+typedef BasicEdgeRange<int, double> EdgeRange;
+
+// Node class representing a bus stop. The graph stores its fields in separate columns;
+// Graph::getNode assembles one by value for code that wants a whole node.
+template <class Id, class Weight>
+class BasicNode {
+public:
+    Id id;
+    uint32_t name_offset;                   // Name in the graph's NameArena; read it with Graph::getNodeName
+    BasicEdgeRange<Id, Weight> edges;       // Edges connected to this node
+
+    // Default constructor
+    BasicNode() : id(static_cast<Id>(-1)), name_offset(0) {}
+
+    // Parameterized constructor
+    BasicNode(Id nodeId, uint32_t nameOffset = 0, BasicEdgeRange<Id, Weight> nodeEdges = BasicEdgeRange<Id, Weight>())
+        : id(nodeId), name_offset(nameOffset), edges(nodeEdges) {}
+};
+typedef BasicNode<int, double> Node;
+
+// "No route" in a weight type: infinity where the type has one, otherwise its largest value,
+// so integer weights need every route total to stay below it (about 4.3 billion for uint32_t)
+template <class Weight>
+Weight unreachableWeight() {
+    return numeric_limits<Weight>::has_infinity ? numeric_limits<Weight>::infinity() : numeric_limits<Weight>::max();
+}
+
+
+
+// Struct to hold pathfinding results
+struct PathDetails {
+    double total_weight = DOUBLE_INF;    // For Dijkstra's (e.g., distance, time)
+    int num_stops = -1;                  // For BFS (number of segments/edges in path)
+                                         // -1 or INT_INF can indicate no path or not applicable
+    vector<int> node_ids_in_path;
+    bool path_exists = false;
+    SearchStats stats;                   // Filled when the search ran with CountSearchStats
+
+    // Default constructor
+    PathDetails() = default;
+};
+
+
+// Graph class using adjacency list representation, stored as structure-of-arrays.
+//
+// Each node field is its own column indexed by node ID, and every node's edges sit in one slice
+// of a shared edge pool, so a search walks a few dense arrays instead of chasing one heap block
+// per edge. A node whose slice is full moves to the end of the pool with twice the room; the
+// slice it leaves is dead space that compactEdges() reclaims, which also lays the slices out in
+// node order. addEdge compacts by itself once dead space outweighs live edges.
+//
+// Id is the type stored for node IDs in the columns and edges, Weight the type of edge weights
+// and of the distances the searches keep. Graph, the (int, double) original, is what the
+// frontends and most engines use; CompactGraph (uint32_t, uint32_t) and CompactFloatGraph
+// (uint32_t, float) halve the edge pool to 8-byte edges for whole-minute data, and the first
+// runs its searches on an integer heap. Node counts, indices and -1 for "none" stay int in the
+// interface whatever Id is, and results are PathDetails with double totals.
+template <class Id, class Weight>
+class BasicGraph {
+public:
+    typedef BasicEdge<Id, Weight> EdgeType;
+    typedef BasicEdgeRange<Id, Weight> EdgeRangeType;
+    typedef BasicNode<Id, Weight> NodeType;
+
+    // Where a node's edges are in the edge pool
+    struct AdjacencyRange {
+        uint32_t first = 0;     // Index of the first edge
+        uint32_t count = 0;     // Edges in use
+        uint32_t capacity = 0;  // Slots reserved from first
+    };
+
+    int numNodes;
+    NameArena names;         // Interned stop names, shared by every node with the same name
+    NameIndex name_index;    // Sorted stop names; addNode keeps it current, rebuildNameIndex() after setNodeName
+
+private:
+    vector<Id> node_ids;                // ID column
+    vector<uint32_t> name_offsets;      // Name column, offsets into names
+    vector<AdjacencyRange> adjacency;   // Adjacency-range column
+    vector<EdgeType> edge_pool;         // Every node's edges, one slice per node
+    size_t dead_edges = 0;              // Pool slots no node owns any more
+
+    // Resize the edge pool, doubling its storage when it runs out; each reallocation is traced
+    void resizePool(size_t size) {
+        if (size > edge_pool.capacity()) {
+            TraceSpan span("grow edge pool", "graph");
+            edge_pool.reserve(max(size, edge_pool.capacity() * 2));
+        }
+        edge_pool.resize(size);
+    }
+
+    // Append an edge to one node's slice, moving the slice to the end of the pool when it is full
+    void appendEdge(int node_id, const EdgeType& edge) {
+        AdjacencyRange& range = adjacency[node_id];
+        if (range.count == range.capacity) {
+            uint32_t grown = range.capacity < 2 ? 4 : range.capacity * 2;
+            if (range.capacity != 0 && range.first + range.capacity == edge_pool.size()) {
+                resizePool(range.first + grown); // Last slice in the pool grows where it is
+            } else {
+                uint32_t moved_to = static_cast<uint32_t>(edge_pool.size());
+                resizePool(edge_pool.size() + grown);
+                copy(edge_pool.begin() + range.first, edge_pool.begin() + range.first + range.count, edge_pool.begin() + moved_to);
+                dead_edges += range.capacity;
+                range.first = moved_to;
+            }
+            range.capacity = grown;
+        }
+        edge_pool[range.first + range.count++] = edge;
+    }
+
+public:
+    // Constructor
+    BasicGraph(int n = 0) : numNodes(0) {
+        resizeNodes(n);
+    }
+
+    // Set the number of nodes. New nodes get their index as ID, no name and no edges.
+    void resizeNodes(int n) {
+        int old_size = static_cast<int>(node_ids.size());
+        node_ids.resize(n);
+        name_offsets.resize(n, 0);
+        adjacency.resize(n);
+        for (int i = old_size; i < n; i++) {
+            node_ids[i] = i;
+        }
+        numNodes = n;
+    }
+
+    // Drop every node and edge (names stay interned)
+    void clearNodes() {
+        node_ids.clear();
+        name_offsets.clear();
+        adjacency.clear();
+        edge_pool.clear();
+        dead_edges = 0;
+        numNodes = 0;
+    }
+
+    // Rewrite the edge pool with each node's edges packed in node order and no spare slots.
+    // Loaders call this once all edges are in, so neighbouring IDs have neighbouring edges.
+    void compactEdges() {
+        TraceSpan span("compact edges", "graph");
+        vector<EdgeType> packed;
+        packed.reserve(edge_pool.size() - dead_edges);
+        for (int i = 0; i < numNodes; i++) {
+            AdjacencyRange& range = adjacency[i];
+            uint32_t first = static_cast<uint32_t>(packed.size());
+            packed.insert(packed.end(), edge_pool.begin() + range.first, edge_pool.begin() + range.first + range.count);
+            range.first = first;
+            range.capacity = range.count;
+        }
+        edge_pool.swap(packed);
+        dead_edges = 0;
+    }
+
+    // Replace this graph with a copy of source, converting IDs and weights to this graph's types.
+    // Integer weights must be whole numbers below unreachableWeight; otherwise this reports the
+    // first weight that does not fit, leaves the graph empty and returns false.
+    template <class OtherId, class OtherWeight>
+    bool copyFrom(const BasicGraph<OtherId, OtherWeight>& source) {
+        clearNodes();
+        int n = source.getNumNodes();
+        for (int i = 0; i < n; i++) addNode(i, source.getNodeName(i));
+        for (int i = 0; i < n; i++) {
+            for (const BasicEdge<OtherId, OtherWeight>& edge : source.edgesOf(i)) {
+                long double value = static_cast<long double>(edge.weight);
+                bool fits = value >= static_cast<long double>(numeric_limits<Weight>::lowest()) &&
+                            value <= static_cast<long double>(numeric_limits<Weight>::max());
+                Weight weight = fits ? static_cast<Weight>(edge.weight) : Weight(0);
+                if (numeric_limits<Weight>::is_integer && (!fits || static_cast<long double>(weight) != value ||
+                                                           weight == unreachableWeight<Weight>())) {
+                    cerr << "Error: Weight " << edge.weight << " of the edge from node " << i
+                         << " does not fit this graph's integer weights." << endl;
+                    clearNodes();
+                    return false;
+                }
+                appendEdge(i, EdgeType(static_cast<Id>(edge.destination_node_id), weight)); // Both directions come from source
+            }
+        }
+        compactEdges();
+        return true;
+    }
+
+    // Add a node to the graph (or update if exists)
+    void addNode(int id, string_view name = "") {
+        if (id >= numNodes) {
+            resizeNodes(id + 1); // New nodes in between get their index as ID
+        }
+        // Now update the node at 'id'
+        uint32_t name_offset = names.intern(name);
+        node_ids[id] = id;
+        name_offsets[id] = name_offset;
+        adjacency[id].count = 0; // Keeps its slots for the edges that come next
+        if (name_offset != 0) {
+            name_index.insert(names, name_offset, id);
+            tagName(id, name_offset);
+        }
+    }
+
+    // Remember the lowest node ID with this name in the arena, for O(1) exact lookups
+    void tagName(int id, uint32_t name_offset) {
+        int tagged = names.tag(name_offset);
+        if (tagged == -1 || tagged > id || !isCurrentName(tagged, name_offset)) {
+            names.setTag(name_offset, id);
+        }
+    }
+
+    // Rename a node without touching the name index; loaders call rebuildNameIndex() afterwards
+    void setNodeName(int id, string_view name) {
+        name_offsets[id] = names.intern(name);
+    }
+
+    // Re-index every name, e.g. after a loader named nodes with setNodeName
+    void rebuildNameIndex() {
+        TraceSpan span("build name index", "graph");
+        vector<NameIndex::Entry> entries;
+        entries.reserve(numNodes);
+        for (int i = 0; i < numNodes; i++) {
+            if (name_offsets[i] != 0) entries.push_back(NameIndex::Entry{name_offsets[i], i});
+        }
+        for (int i = numNodes - 1; i >= 0; i--) {
+            if (name_offsets[i] != 0) names.setTag(name_offsets[i], i);
+        }
+        name_index.build(names, move(entries));
+    }
+
+    // Whether an index entry still matches the node's name (renamed nodes leave stale entries)
+    bool isCurrentName(int id, uint32_t name_offset) const {
+        return id >= 0 && id < numNodes && name_offsets[id] == name_offset;
+    }
+
+    // Add an edge between two nodes (undirected)
+    void addEdge(int source_id, int destination_id, Weight weight) {
+        if (source_id >= numNodes || destination_id >= numNodes || source_id < 0 || destination_id < 0) {
+            throw out_of_range("addEdge: Node index out of bounds. Ensure nodes are added before edges.");
+        }
+
+        appendEdge(source_id, EdgeType(destination_id, weight));
+        appendEdge(destination_id, EdgeType(source_id, weight)); // Assuming undirected
+        if (dead_edges > edge_pool.size() / 2) {
+            compactEdges();
+        }
+    }
+
+    // Get the number of nodes
+    int getNumNodes() const { return numNodes; }
+
+    // Get a node by its ID, assembled from the columns. Its edges are valid until the next addEdge.
+    NodeType getNode(int id) const {
+        if (id >= numNodes || id < 0) {
+            throw out_of_range("getNode: Node index out of bounds");
+        }
+        return NodeType(node_ids[id], name_offsets[id], edgesOf(id));
+    }
+
+    // A node's name. Interning a new name may move the arena, so copy the view to keep it across addNode
+    string_view getNodeName(int id) const {
+        return names.view(getNode(id).name_offset);
+    }
+
+    // Exact lookup through the name index (lowest ID on duplicates). Blank names are not indexed.
+    int getNodeIndexByname(string_view name) const {
+        uint32_t name_offset = names.find(name);
+        if (name_offset == NameArena::NOT_FOUND) {
+            return -1; // Never interned, so no node has it
+        }
+        if (name_offset != 0) {
+            // The tag is right unless that node has since been renamed; then ask the index
+            int tagged = names.tag(name_offset);
+            if (tagged != -1 && isCurrentName(tagged, name_offset)) {
+                return tagged;
+            }
+            return name_index.find(names, name_offset, [this](int id, uint32_t indexed) { return isCurrentName(id, indexed); });
+        }
+        for (int i = 0; i < numNodes; i++) {
+            if (name_offsets[i] == 0) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // IDs of up to limit stops whose names start with prefix, alphabetically
+    vector<int> findNodesByPrefix(string_view prefix, size_t limit) const {
+        return name_index.findPrefix(names, prefix, limit, [this](int id, uint32_t indexed) { return isCurrentName(id, indexed); });
+    }
+
+    // Get all edges of a node. The range is valid until the next addEdge.
+    EdgeRangeType getEdges(int nodeId) const {
+        if (nodeId >= numNodes || nodeId < 0) {
+            throw out_of_range("getEdges: Node index out of bounds");
+        }
+        return edgesOf(nodeId);
+    }
+
+    // Unchecked edges of a node, for the search loops
+    EdgeRangeType edgesOf(int nodeId) const {
+        const EdgeType* first = edge_pool.data() + adjacency[nodeId].first;
+        return EdgeRangeType(first, first + adjacency[nodeId].count);
+    }
+
+    // Heap memory held by the graph: columns, edge pool (dead slots included), names and index
+    size_t sizeInBytes() const {
+        return node_ids.capacity() * sizeof(Id) + name_offsets.capacity() * sizeof(uint32_t) +
+               adjacency.capacity() * sizeof(AdjacencyRange) + edge_pool.capacity() * sizeof(EdgeType) +
+               names.sizeInBytes() + name_index.sizeInBytes();
+    }
+
+    // Print the graph structure
+    void printGraph() const {
+        cout << "\n--- Graph Structure ---" << endl;
+        for (int i = 0; i < numNodes; i++) {
+            cout << "Node " << node_ids[i];
+            if (name_offsets[i] != 0) {
+                cout << " (" << getNodeName(i) << ")";
+            }
+
+            if (adjacency[i].count == 0) {
+                cout << "None";
+            } else {
+                for (const EdgeType& edge : edgesOf(i)) {
+                    cout << edge.destination_node_id << "(" << fixed << setprecision(1) << edge.weight << ") ";
+                }
+            }
+            cout << endl;
+        }
+        cout << "-----------------------\n" << endl;
+    }
+
+    // Create the adjacency matrix (Commented out as not essential for core Dijkstra/BFS with adjacency lists)
+    typedef vector<vector<double>> AdjacencyMatrix;
+    AdjacencyMatrix createAdjacencyMatrix() const {
+        vector<vector<double>> matrix(numNodes, vector<double>(numNodes, DOUBLE_INF));
+
+        for (int i = 0; i < numNodes; ++i) {
+            matrix[i][i] = 0.0; // Distance to self is 0
+        }
+
+        for (int i = 0; i < numNodes; i++) {
+            for (const EdgeType& edge : edgesOf(i)) {
+                matrix[i][edge.destination_node_id] = edge.weight;
+            }
+        }
+        return matrix;
+    }
+
+    // Print the adjacency matrix (Commented out)
+    void printAdjacencyMatrix() const {
+        vector<vector<double>> matrix = createAdjacencyMatrix();
+
+        cout << "\nAdjacency Matrix (distances between stops):\n";
+        cout << setw(6) << " "; // Adjusted for node names potentially
+        for (int i = 0; i < numNodes; i++) {
+            cout << setw(8) << getNodeName(i).substr(0,7) ; // Print part of name
+        }
+        cout << "\n";
+
+        for (int i = 0; i < numNodes; i++) {
+            cout << setw(5) << getNodeName(i).substr(0,4) << " |";
+            for (int j = 0; j < numNodes; j++) {
+                if (matrix[i][j] == DOUBLE_INF) {
+                    cout << setw(8) << "INF";
+                } else {
+                    cout << setw(8) << fixed << setprecision(1) << matrix[i][j];
+                }
+            }
+            cout << "\n";
+        }
+        cout << endl;
+    }
+
+    template <class Stats = NoSearchStats>
+    PathDetails Dijkstra(int startNodeId, int endNodeId) const {
+        TraceSpan span("Dijkstra", "search");
+        Stats counters;
+        PathDetails result;
+        result.path_exists = false;
+
+        if (startNodeId >= numNodes || endNodeId >= numNodes || startNodeId < 0 || endNodeId < 0) {
+            cerr << "Error: Invalid start or end node ID in Dijkstra." << endl;
+            return result;
+        }
+
+        if (startNodeId == endNodeId) {
+            result.path_exists = true;
+            result.node_ids_in_path.push_back(startNodeId);
+            result.num_stops = 0;
+            // Total_weight can remain DOUBLE_INF or be set to 0.0 as it's 0 stops.
+            // For consistency, if a path to self exists, weight is 0.
+            result.total_weight = 0.0;
+            counters.finish(result.stats);
+            return result;
+        }
+
+        vector<Weight> distances(numNodes, unreachableWeight<Weight>());
+        vector<int> previous(numNodes, -1);
+        vector<bool> visited(numNodes, false);
+
+        distances[startNodeId] = 0;
+
+        priority_queue<pair<Weight, int>, vector<pair<Weight, int>>, greater<pair<Weight, int>>> pq;
+        pq.push({Weight(0), startNodeId});
+        counters.pushed(pq.size());
+
+        while (!pq.empty()) {
+            Weight removed_distance = pq.top().first; // Renamed for clarity
+            int removed_node_id = pq.top().second;
+            pq.pop();
+            counters.popped();
+            if (visited[removed_node_id]) {
+                counters.stale(); // Settled already through a shorter entry
+                continue;
+            }
+            visited[removed_node_id] = true;
+            counters.settled();
+            for (const EdgeType& edge : edgesOf(removed_node_id)) {
+                counters.relaxed();
+                if (visited[edge.destination_node_id]) {
+                    continue;
+                }
+                Weight new_distance = removed_distance + edge.weight;
+                if (new_distance < distances[edge.destination_node_id]) {
+                    distances[edge.destination_node_id] = new_distance;
+                    previous[edge.destination_node_id] = removed_node_id;
+                    pq.push({new_distance, edge.destination_node_id});
+                    counters.pushed(pq.size());
+                }
+            }
+        }
+        // Path Reconstruction (remains the same as before)
+        if (distances[endNodeId] != unreachableWeight<Weight>()) {
+            result.path_exists = true;
+            result.total_weight = distances[endNodeId];
+
+            // Walk the parents back from the end, then reverse in place
+            for (int current_node_id = endNodeId; current_node_id != -1; current_node_id = previous[current_node_id]) {
+                result.node_ids_in_path.push_back(current_node_id);
+            }
+            reverse(result.node_ids_in_path.begin(), result.node_ids_in_path.end());
+            result.num_stops = static_cast<int>(result.node_ids_in_path.size()) - 1;
+        }
+        counters.finish(result.stats);
+        return result;
+    }
+
+    template <class Stats = NoSearchStats>
+    PathDetails BFS(int startNodeId, int endNodeId) const {
+        TraceSpan span("BFS", "search");
+        Stats counters;
+        PathDetails result;
+        result.path_exists = false; // Assume no path initially
+        // Default: num_stops = -1, total_weight = DOUBLE_INF
+
+        // Error Handling
+        if (startNodeId >= numNodes || endNodeId >= numNodes || startNodeId < 0 || endNodeId < 0) {
+            cerr << "Error: Invalid start or end node ID in BFS." << endl; // Optional
+            return result;
+        }
+
+        // Error Handling
+        if (startNodeId == endNodeId) {
+            result.path_exists = true;
+            result.node_ids_in_path.push_back(startNodeId);
+            result.num_stops = 0;
+            result.total_weight = 0.0;
+            counters.finish(result.stats);
+            return result;
+        }
+
+        // Start of BFS
+        queue<int> q;
+        q.push(startNodeId);
+        counters.pushed(q.size());
+
+        vector<bool> visited(numNodes, false);
+        visited[startNodeId] = true;
+
+        vector<int> prev(numNodes, -1);
+
+        bool path_found_to_end_node = false; // Flag to indicate if endNodeId was reached
+
+        while (!q.empty()) {
+            int u_node_id = q.front();
+            q.pop();
+            counters.popped();
+            counters.settled();
+
+            if (u_node_id == endNodeId) {
+                path_found_to_end_node = true;
+                break;
+            }
+
+            // Explore neighbors
+            for (const EdgeType& edge : edgesOf(u_node_id)) {
+                counters.relaxed();
+                int v_node_id = edge.destination_node_id;
+                if (!visited[v_node_id]) {
+                    visited[v_node_id] = true;
+                    prev[v_node_id] = u_node_id;
+                    q.push(v_node_id);
+                    counters.pushed(q.size());
+                }
+            }
+        }
+
+        // Reconstruct path if the end node was reached
+        if (path_found_to_end_node) {
+            for (int current_node_id = endNodeId; current_node_id != -1; current_node_id = prev[current_node_id]) {
+                result.node_ids_in_path.push_back(current_node_id);
+            }
+            reverse(result.node_ids_in_path.begin(), result.node_ids_in_path.end());
+            result.path_exists = true;
+            result.num_stops = static_cast<int>(result.node_ids_in_path.size()) - 1;
+        }
+        counters.finish(result.stats);
+        return result;
+    }
+};
+
+typedef BasicGraph<int, double> Graph;
+typedef BasicGraph<uint32_t, uint32_t> CompactGraph;
+typedef BasicGraph<uint32_t, float> CompactFloatGraph;
+
 #endif // GRAPH_H
\ No newline at end of file
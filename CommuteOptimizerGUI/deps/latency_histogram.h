@@ -0,0 +1,102 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+
+using namespace std;
+
+// p50/p99/max of a histogram, in milliseconds
+struct LatencySummary {
+    uint64_t count = 0;
+    double p50_ms = 0;
+    double p99_ms = 0;
+    double max_ms = 0;
+};
+
+// HDR-style latency histogram over microseconds.
+//
+// Buckets are log-linear: values below 32 us get one bucket each, and every power of two above
+// that is split into 32 equal sub-buckets, so any recorded value is known to within about 3% from
+// 1 us up to days, in a fixed table of 1152 counters. Recording is one relaxed atomic increment
+// (plus a compare-exchange on a new maximum), so the worker thread can record every query while
+// the render thread reads the same table; a reader may see a count a query or two behind.
+class LatencyHistogram {
+private:
+    static const int SUB_BUCKET_BITS = 5;
+    static const uint64_t SUB_BUCKETS = 1ull << SUB_BUCKET_BITS;
+    static const int MAX_SHIFT = 34;            // Top bucket starts at 2^39 us
+    static const int NUM_BUCKETS = static_cast<int>(SUB_BUCKETS) * (MAX_SHIFT + 2);
+
+    atomic<uint64_t> counts[NUM_BUCKETS];
+    atomic<uint64_t> total;
+    atomic<uint64_t> max_value;
+
+    static int bucketOf(uint64_t us) {
+        if (us < SUB_BUCKETS) return static_cast<int>(us);
+        int shift = 0;
+        while ((us >> shift) >= 2 * SUB_BUCKETS) shift++;
+        if (shift > MAX_SHIFT) return NUM_BUCKETS - 1;
+        return static_cast<int>(SUB_BUCKETS * (shift + 1) + ((us >> shift) - SUB_BUCKETS));
+    }
+
+    // Largest value that lands in a bucket
+    static uint64_t highestIn(int bucket) {
+        if (bucket < static_cast<int>(SUB_BUCKETS)) return static_cast<uint64_t>(bucket);
+        int shift = bucket / static_cast<int>(SUB_BUCKETS) - 1;
+        uint64_t sub = SUB_BUCKETS + bucket % SUB_BUCKETS;
+        return ((sub + 1) << shift) - 1;
+    }
+
+public:
+    LatencyHistogram() { clear(); }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t us) {
+        counts[bucketOf(us)].fetch_add(1, memory_order_relaxed);
+        total.fetch_add(1, memory_order_relaxed);
+        uint64_t seen = max_value.load(memory_order_relaxed);
+        while (us > seen && !max_value.compare_exchange_weak(seen, us, memory_order_relaxed)) {
+        }
+    }
+
+    // Not safe against a concurrent record(); call while nothing is recording
+    void clear() {
+        for (atomic<uint64_t>& count : counts) count.store(0, memory_order_relaxed);
+        total.store(0, memory_order_relaxed);
+        max_value.store(0, memory_order_relaxed);
+    }
+
+    uint64_t count() const { return total.load(memory_order_relaxed); }
+
+    // Smallest bucket bound with at least percentile% of the values at or below it, in microseconds
+    uint64_t valueAtPercentile(double percentile) const {
+        uint64_t recorded = count();
+        if (recorded == 0) return 0;
+        uint64_t wanted = static_cast<uint64_t>(percentile / 100.0 * recorded + 0.5);
+        if (wanted == 0) wanted = 1;
+        uint64_t seen = 0;
+        for (int b = 0; b < NUM_BUCKETS; b++) {
+            seen += counts[b].load(memory_order_relaxed);
+            if (seen >= wanted) {
+                uint64_t highest = highestIn(b);
+                uint64_t largest = max_value.load(memory_order_relaxed);
+                return highest < largest ? highest : largest;
+            }
+        }
+        return max_value.load(memory_order_relaxed);
+    }
+
+    LatencySummary summary() const {
+        LatencySummary result;
+        result.count = count();
+        result.p50_ms = valueAtPercentile(50) / 1000.0;
+        result.p99_ms = valueAtPercentile(99) / 1000.0;
+        result.max_ms = max_value.load(memory_order_relaxed) / 1000.0;
+        return result;
+    }
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,416 @@
+#ifndef MAP_VIEW_H
+#define MAP_VIEW_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <imgui.h>
+#include "graphV1.h"
+
+using namespace std;
+
+// Pan/zoom drawing of the whole network with routes highlighted on top.
+//
+// Stops have no coordinates, so they get a radial layout: the university at the centre, each stop
+// on the ring of its hop count, and every subtree of the BFS tree given an angular wedge
+// proportional to its size. The layout is bucketed into a uniform grid (stops by cell, roads by
+// every cell their bounding box touches) so only cells under the view are visited.
+//
+// Laying out 10^5 stops takes tens of milliseconds, so a MapLayout is built on the QueryRunner
+// thread and handed to the view whole; until it arrives the view keeps drawing the previous one.
+//
+// The visible geometry is converted to panel coordinates once and cached; it is rebuilt only when
+// the layout, the view, the panel size or the highlighted routes change. Far zoomed out,
+// roads shorter than a pixel and stops landing on an already drawn pixel are dropped, so the cost
+// of a frame is bounded by the panel area rather than by the size of the network.
+struct MapLayout {
+    unsigned long long graph_version;   // Graph version the layout was built from
+
+    // Positions, in world units (one ring per hop)
+    vector<float> node_x, node_y;
+    vector<pair<int, int>> roads;   // Each undirected road once, lower ID first
+    float min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+
+    // Uniform grid index, compressed rows: cell c owns [offset[c], offset[c + 1])
+    int grid_w = 1, grid_h = 1;
+    float cell_size = 1.0f;
+    vector<int> cell_node_offset, cell_nodes;
+    vector<int> cell_road_offset, cell_roads;
+    vector<int> long_roads;         // Roads spanning too many cells; always tested
+
+    static const int MAX_CELLS_PER_ROAD = 16;
+
+    // Reads only the graph, so it may run on any thread that holds a snapshot
+    MapLayout(const Graph& graph, unsigned long long version) : graph_version(version) {
+        placeStops(graph);
+        buildGrid();
+    }
+
+    // Clamped while still a float: a point far outside the grid would overflow the int
+    int cellX(float x) const { return static_cast<int>(min(static_cast<float>(grid_w - 1), max(0.0f, (x - min_x) / cell_size))); }
+    int cellY(float y) const { return static_cast<int>(min(static_cast<float>(grid_h - 1), max(0.0f, (y - min_y) / cell_size))); }
+
+private:
+    void placeStops(const Graph& graph) {
+        int numNodes = graph.getNumNodes();
+        node_x.assign(numNodes, 0.0f);
+        node_y.assign(numNodes, 0.0f);
+        roads.clear();
+        if (numNodes == 0) return;
+
+        // BFS tree from the university
+        vector<int> parent(numNodes, -1), depth(numNodes, -1), order;
+        order.reserve(numNodes);
+        depth[0] = 0;
+        order.push_back(0);
+        for (size_t head = 0; head < order.size(); head++) {
+            int u = order[head];
+            for (const Edge& edge : graph.getEdges(u)) {
+                int v = edge.destination_node_id;
+                if (depth[v] == -1) {
+                    depth[v] = depth[u] + 1;
+                    parent[v] = u;
+                    order.push_back(v);
+                }
+            }
+        }
+
+        // Leaves below each stop decide the width of its wedge
+        vector<double> leaves(numNodes, 0.0);
+        for (size_t i = order.size(); i-- > 0;) {
+            int u = order[i];
+            if (leaves[u] == 0.0) leaves[u] = 1.0;
+            if (parent[u] != -1) leaves[parent[u]] += leaves[u];
+        }
+        vector<double> wedge_start(numNodes, 0.0), wedge_span(numNodes, 0.0), cursor(numNodes, 0.0);
+        const double full_turn = 2.0 * acos(-1.0);
+        wedge_span[0] = full_turn;
+        int max_depth = 0;
+        for (int u : order) {
+            int p = parent[u];
+            if (p != -1) {
+                wedge_span[u] = wedge_span[p] * leaves[u] / leaves[p];
+                wedge_start[u] = wedge_start[p] + cursor[p];
+                cursor[p] += wedge_span[u];
+            }
+            cursor[u] = 0.0;
+            double angle = wedge_start[u] + wedge_span[u] * 0.5;
+            node_x[u] = static_cast<float>(depth[u] * cos(angle));
+            node_y[u] = static_cast<float>(depth[u] * sin(angle));
+            max_depth = max(max_depth, depth[u]);
+        }
+
+        // Stops cut off from the university go on a ring of their own outside the rest
+        int unreached = numNodes - static_cast<int>(order.size());
+        for (int u = 0, k = 0; u < numNodes; u++) {
+            if (depth[u] != -1) continue;
+            double angle = full_turn * k++ / unreached;
+            node_x[u] = static_cast<float>((max_depth + 2) * cos(angle));
+            node_y[u] = static_cast<float>((max_depth + 2) * sin(angle));
+        }
+
+        for (int u = 0; u < numNodes; u++) {
+            for (const Edge& edge : graph.getEdges(u)) {
+                if (u < edge.destination_node_id) roads.push_back(make_pair(u, edge.destination_node_id));
+            }
+        }
+        min_x = *min_element(node_x.begin(), node_x.end());
+        max_x = *max_element(node_x.begin(), node_x.end());
+        min_y = *min_element(node_y.begin(), node_y.end());
+        max_y = *max_element(node_y.begin(), node_y.end());
+    }
+
+    void buildGrid() {
+        int numNodes = static_cast<int>(node_x.size());
+        float extent = max(max_x - min_x, max_y - min_y) + 1e-3f;
+        // About four stops per cell
+        int side = max(1, min(1024, static_cast<int>(sqrt(numNodes / 4.0))));
+        cell_size = extent / side;
+        grid_w = static_cast<int>((max_x - min_x) / cell_size) + 1;
+        grid_h = static_cast<int>((max_y - min_y) / cell_size) + 1;
+        int cells = grid_w * grid_h;
+
+        cell_node_offset.assign(cells + 1, 0);
+        for (int u = 0; u < numNodes; u++) cell_node_offset[cellY(node_y[u]) * grid_w + cellX(node_x[u]) + 1]++;
+        for (int c = 0; c < cells; c++) cell_node_offset[c + 1] += cell_node_offset[c];
+        cell_nodes.resize(numNodes);
+        vector<int> next_slot(cell_node_offset.begin(), cell_node_offset.end() - 1);
+        for (int u = 0; u < numNodes; u++) cell_nodes[next_slot[cellY(node_y[u]) * grid_w + cellX(node_x[u])]++] = u;
+
+        // Roads go in every cell their bounding box covers, unless that is too many
+        cell_road_offset.assign(cells + 1, 0);
+        long_roads.clear();
+        auto forEachCell = [&](int r, bool count) {
+            int u = roads[r].first, v = roads[r].second;
+            int x0 = cellX(min(node_x[u], node_x[v])), x1 = cellX(max(node_x[u], node_x[v]));
+            int y0 = cellY(min(node_y[u], node_y[v])), y1 = cellY(max(node_y[u], node_y[v]));
+            if ((x1 - x0 + 1) * (y1 - y0 + 1) > MAX_CELLS_PER_ROAD) {
+                if (count) long_roads.push_back(r);
+                return;
+            }
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++) {
+                    int c = y * grid_w + x;
+                    if (count) cell_road_offset[c + 1]++;
+                    else cell_roads[next_slot[c]++] = r;
+                }
+            }
+        };
+        for (int r = 0; r < static_cast<int>(roads.size()); r++) forEachCell(r, true);
+        for (int c = 0; c < cells; c++) cell_road_offset[c + 1] += cell_road_offset[c];
+        cell_roads.resize(cell_road_offset[cells]);
+        next_slot.assign(cell_road_offset.begin(), cell_road_offset.end() - 1);
+        for (int r = 0; r < static_cast<int>(roads.size()); r++) forEachCell(r, false);
+    }
+};
+
+// Pan, zoom and the cached panel geometry over the latest MapLayout
+class NetworkMapView {
+private:
+    // View: world point at the panel centre and pixels per world unit
+    float centre_x = 0, centre_y = 0, zoom = 1.0f;
+    bool fitted = false;
+
+    shared_ptr<const MapLayout> layout;     // Null until the first one arrives
+    vector<unsigned> road_stamp;    // Deduplicates roads met in several cells
+    unsigned stamp = 0;
+
+    // Cached geometry, relative to the panel's top-left corner
+    vector<ImVec2> road_vertices;   // Pairs of end points
+    vector<ImVec2> stop_points;
+    vector<vector<ImVec2>> route_lines;
+    vector<unsigned> pixel_stamp;   // Deduplicates stops landing on the same pixel
+    unsigned pixel_generation = 0;
+
+    struct CacheKey {
+        unsigned long long graph_version = 0, routes_version = 0;
+        float centre_x = 0, centre_y = 0, zoom = 0, width = 0, height = 0;
+
+        bool operator==(const CacheKey& other) const {
+            return graph_version == other.graph_version && routes_version == other.routes_version &&
+                   centre_x == other.centre_x && centre_y == other.centre_y && zoom == other.zoom &&
+                   width == other.width && height == other.height;
+        }
+    } cached;
+
+    void fitView(float width, float height) {
+        centre_x = (layout->min_x + layout->max_x) * 0.5f;
+        centre_y = (layout->min_y + layout->max_y) * 0.5f;
+        float extent = max(layout->max_x - layout->min_x, layout->max_y - layout->min_y) + 2.0f;
+        zoom = min(width, height) / extent;
+        fitted = true;
+    }
+
+    // Keep the panel centre over the network so panning cannot run off to huge coordinates
+    void clampCentre() {
+        centre_x = min(layout->max_x, max(layout->min_x, centre_x));
+        centre_y = min(layout->max_y, max(layout->min_y, centre_y));
+    }
+
+    ImVec2 toPanel(int u, float width, float height) const {
+        return ImVec2((layout->node_x[u] - centre_x) * zoom + width * 0.5f, (layout->node_y[u] - centre_y) * zoom + height * 0.5f);
+    }
+
+    void rebuildGeometry(const vector<vector<int>>& routes, float width, float height) {
+        road_vertices.clear();
+        stop_points.clear();
+        route_lines.clear();
+        if (!layout || layout->node_x.empty()) return;
+        const MapLayout& map = *layout;
+        const vector<float>& node_x = map.node_x;
+        const vector<float>& node_y = map.node_y;
+
+        // World rectangle under the panel, widened by a cell so roads leaving it are kept
+        float half_w = width * 0.5f / zoom, half_h = height * 0.5f / zoom;
+        float view_x0 = centre_x - half_w, view_x1 = centre_x + half_w;
+        float view_y0 = centre_y - half_h, view_y1 = centre_y + half_h;
+        int cx0 = map.cellX(view_x0), cx1 = map.cellX(view_x1);
+        int cy0 = map.cellY(view_y0), cy1 = map.cellY(view_y1);
+        bool view_misses_grid = view_x1 < map.min_x || view_x0 > map.max_x || view_y1 < map.min_y || view_y0 > map.max_y;
+
+        int pixels_w = static_cast<int>(width) + 1, pixels_h = static_cast<int>(height) + 1;
+        if (pixel_stamp.size() < static_cast<size_t>(pixels_w) * pixels_h) {
+            pixel_stamp.assign(static_cast<size_t>(pixels_w) * pixels_h, 0);
+            pixel_generation = 0;
+        }
+        pixel_generation++;
+        if (++stamp == 0) {
+            fill(road_stamp.begin(), road_stamp.end(), 0);
+            stamp = 1;
+        }
+
+        auto addRoad = [&](int r) {
+            if (road_stamp[r] == stamp) return;
+            road_stamp[r] = stamp;
+            int u = map.roads[r].first, v = map.roads[r].second;
+            if (max(node_x[u], node_x[v]) < view_x0 || min(node_x[u], node_x[v]) > view_x1 ||
+                max(node_y[u], node_y[v]) < view_y0 || min(node_y[u], node_y[v]) > view_y1) return;
+            ImVec2 a = toPanel(u, width, height), b = toPanel(v, width, height);
+            if (fabs(a.x - b.x) < 1.0f && fabs(a.y - b.y) < 1.0f) return; // Sub-pixel
+            road_vertices.push_back(a);
+            road_vertices.push_back(b);
+        };
+
+        if (!view_misses_grid) {
+            for (int cy = cy0; cy <= cy1; cy++) {
+                for (int cx = cx0; cx <= cx1; cx++) {
+                    int c = cy * map.grid_w + cx;
+                    for (int i = map.cell_road_offset[c]; i < map.cell_road_offset[c + 1]; i++) addRoad(map.cell_roads[i]);
+                    for (int i = map.cell_node_offset[c]; i < map.cell_node_offset[c + 1]; i++) {
+                        int u = map.cell_nodes[i];
+                        ImVec2 p = toPanel(u, width, height);
+                        if (p.x < 0 || p.y < 0 || p.x >= width || p.y >= height) continue;
+                        unsigned& pixel = pixel_stamp[static_cast<size_t>(p.y) * pixels_w + static_cast<size_t>(p.x)];
+                        if (pixel == pixel_generation) continue;
+                        pixel = pixel_generation;
+                        stop_points.push_back(p);
+                    }
+                }
+            }
+        }
+        for (int r : map.long_roads) addRoad(r);
+
+        // Routes are few and short; draw them whole and let the clip rectangle cut them.
+        // Stops added since the layout was built are skipped until the next one arrives.
+        int numNodes = static_cast<int>(node_x.size());
+        for (const vector<int>& route : routes) {
+            vector<ImVec2> line;
+            for (int u : route) {
+                if (u >= 0 && u < numNodes) line.push_back(toPanel(u, width, height));
+            }
+            route_lines.push_back(line);
+        }
+    }
+
+    // Stop nearest to a panel point, within radius pixels; -1 if none
+    int stopAt(ImVec2 point, float radius, float width, float height) const {
+        if (!layout || layout->node_x.empty()) return -1;
+        const MapLayout& map = *layout;
+        float world_x = centre_x + (point.x - width * 0.5f) / zoom, world_y = centre_y + (point.y - height * 0.5f) / zoom;
+        float reach = radius / zoom;
+        int best = -1;
+        float best_d2 = reach * reach;
+        for (int cy = map.cellY(world_y - reach); cy <= map.cellY(world_y + reach); cy++) {
+            for (int cx = map.cellX(world_x - reach); cx <= map.cellX(world_x + reach); cx++) {
+                int c = cy * map.grid_w + cx;
+                for (int i = map.cell_node_offset[c]; i < map.cell_node_offset[c + 1]; i++) {
+                    int u = map.cell_nodes[i];
+                    float dx = map.node_x[u] - world_x, dy = map.node_y[u] - world_y;
+                    if (dx * dx + dy * dy <= best_d2) {
+                        best_d2 = dx * dx + dy * dy;
+                        best = u;
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+public:
+    NetworkMapView() = default;
+
+    // Graph version of the layout on show, 0 before the first one arrives
+    unsigned long long layoutVersion() const { return layout ? layout->graph_version : 0; }
+
+    // Swap in a layout built elsewhere; the view and the zoom are kept
+    void setLayout(shared_ptr<const MapLayout> next) {
+        if (!next) return;
+        layout = move(next);
+        road_stamp.assign(layout->roads.size(), 0);
+        stamp = 0;
+    }
+
+    // Draw into the current window with the latest layout handed to setLayout(). routes_version
+    // must change whenever routes does; the first route is drawn as the main one.
+    void draw(const Graph& graph, const vector<vector<int>>& routes, unsigned long long routes_version) {
+        if (ImGui::SmallButton("Fit")) fitted = false;
+        ImGui::SameLine();
+        if (!layout) {
+            ImGui::TextDisabled("Laying out the network...");
+        } else {
+            ImGui::TextDisabled("Drag to pan, scroll to zoom. %d stops, %d roads drawn.",
+                                static_cast<int>(stop_points.size()), static_cast<int>(road_vertices.size() / 2));
+        }
+
+        ImVec2 origin = ImGui::GetCursorScreenPos();
+        ImVec2 size = ImGui::GetContentRegionAvail();
+        size.x = max(size.x, 50.0f);
+        size.y = max(size.y, 50.0f);
+        ImGui::InvisibleButton("##NetworkMapCanvas", size);
+        bool hovered = ImGui::IsItemHovered();
+        ImGuiIO& io = ImGui::GetIO();
+
+        if (layout && !fitted) fitView(size.x, size.y);
+        if (layout && ImGui::IsItemActive() && ImGui::IsMouseDragging(ImGuiMouseButton_Left, 0.0f)) {
+            centre_x -= io.MouseDelta.x / zoom;
+            centre_y -= io.MouseDelta.y / zoom;
+            clampCentre();
+        }
+        if (layout && hovered && io.MouseWheel != 0.0f) {
+            // Zoom about the cursor: the world point under it stays put
+            float mx = io.MousePos.x - origin.x - size.x * 0.5f, my = io.MousePos.y - origin.y - size.y * 0.5f;
+            float world_x = centre_x + mx / zoom, world_y = centre_y + my / zoom;
+            zoom = min(1e5f, max(1e-3f, zoom * powf(1.2f, io.MouseWheel)));
+            centre_x = world_x - mx / zoom;
+            centre_y = world_y - my / zoom;
+            clampCentre();
+        }
+
+        CacheKey key;
+        key.graph_version = layoutVersion();
+        key.routes_version = routes_version;
+        key.centre_x = centre_x;
+        key.centre_y = centre_y;
+        key.zoom = zoom;
+        key.width = size.x;
+        key.height = size.y;
+        if (!(key == cached)) {
+            rebuildGeometry(routes, size.x, size.y);
+            cached = key;
+        }
+
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        ImVec2 corner(origin.x + size.x, origin.y + size.y);
+        draw_list->AddRectFilled(origin, corner, IM_COL32(20, 24, 30, 255));
+        draw_list->PushClipRect(origin, corner, true);
+
+        ImU32 road_colour = IM_COL32(90, 110, 130, 255);
+        for (size_t i = 0; i + 1 < road_vertices.size(); i += 2) {
+            draw_list->AddLine(ImVec2(origin.x + road_vertices[i].x, origin.y + road_vertices[i].y),
+                               ImVec2(origin.x + road_vertices[i + 1].x, origin.y + road_vertices[i + 1].y), road_colour);
+        }
+        float stop_radius = min(4.0f, max(1.0f, zoom * 0.15f));
+        ImU32 stop_colour = IM_COL32(200, 210, 220, 255);
+        for (const ImVec2& p : stop_points) {
+            draw_list->AddRectFilled(ImVec2(origin.x + p.x - stop_radius, origin.y + p.y - stop_radius),
+                                     ImVec2(origin.x + p.x + stop_radius, origin.y + p.y + stop_radius), stop_colour);
+        }
+
+        // Alternatives underneath, the main route last so it stays on top
+        for (size_t r = route_lines.size(); r-- > 0;) {
+            const vector<ImVec2>& line = route_lines[r];
+            ImU32 colour = r == 0 ? IM_COL32(255, 190, 40, 255) : IM_COL32(80, 200, 255, 200);
+            for (size_t i = 1; i < line.size(); i++) {
+                draw_list->AddLine(ImVec2(origin.x + line[i - 1].x, origin.y + line[i - 1].y),
+                                   ImVec2(origin.x + line[i].x, origin.y + line[i].y), colour, r == 0 ? 4.0f : 2.5f);
+            }
+            if (r == 0 && !line.empty()) {
+                draw_list->AddCircleFilled(ImVec2(origin.x + line.front().x, origin.y + line.front().y), 6.0f, IM_COL32(60, 220, 90, 255));
+                draw_list->AddCircleFilled(ImVec2(origin.x + line.back().x, origin.y + line.back().y), 6.0f, IM_COL32(230, 60, 60, 255));
+            }
+        }
+        draw_list->PopClipRect();
+
+        if (hovered) {
+            int stop = stopAt(ImVec2(io.MousePos.x - origin.x, io.MousePos.y - origin.y), 6.0f, size.x, size.y);
+            if (stop != -1 && stop < graph.getNumNodes()) {
+                string_view name = graph.getNodeName(stop);
+                ImGui::SetTooltip("%.*s (ID: %d)", static_cast<int>(name.size()), name.data(), stop);
+            }
+        }
+    }
+};
+
+#endif // MAP_VIEW_H
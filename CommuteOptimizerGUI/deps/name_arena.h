@@ -0,0 +1,118 @@
+#ifndef NAME_ARENA_H
+#define NAME_ARENA_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Append-only pool of interned stop names.
+//
+// Every distinct name is stored once in one contiguous byte buffer as a 32-bit length, a 32-bit
+// tag, the characters and a terminating NUL, and is referred to by the 32-bit offset of its record.
+// The tag is free for the owner; Graph keeps the lowest node ID with that name there.
+// Equal names get equal offsets, so comparing two names for equality is comparing offsets.
+// Offset 0 is always the empty name. Names are never removed; renaming a stop just points it at
+// another record. Copying the arena copies two flat vectors, which is all a snapshot needs.
+class NameArena {
+public:
+    static constexpr uint32_t NOT_FOUND = 0xFFFFFFFFu;
+
+private:
+    vector<char> bytes;
+    vector<uint32_t> slots;     // Open-addressing hash table of record offsets; NOT_FOUND = empty
+    size_t count = 0;           // Names in the table (the empty name is not)
+
+    static uint64_t hashOf(string_view name) {
+        uint64_t hash = 1469598103934665603ULL;  // FNV-1a
+        for (unsigned char c : name) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    static const size_t HEADER = 2 * sizeof(uint32_t);  // Length, then tag
+
+    uint32_t append(string_view name) {
+        uint32_t offset = static_cast<uint32_t>(bytes.size());
+        uint32_t length = static_cast<uint32_t>(name.size());
+        int32_t tag = -1;
+        bytes.resize(bytes.size() + HEADER + name.size() + 1);
+        memcpy(&bytes[offset], &length, sizeof(length));
+        memcpy(&bytes[offset + sizeof(length)], &tag, sizeof(tag));
+        if (!name.empty()) memcpy(&bytes[offset + HEADER], name.data(), name.size());
+        bytes.back() = '\0';
+        return offset;
+    }
+
+    // Slot holding name, or the empty slot where it would go
+    size_t probe(string_view name) const {
+        size_t mask = slots.size() - 1;
+        for (size_t slot = hashOf(name) & mask;; slot = (slot + 1) & mask) {
+            if (slots[slot] == NOT_FOUND || view(slots[slot]) == name) return slot;
+        }
+    }
+
+    void grow() {
+        vector<uint32_t> old;
+        old.swap(slots);
+        slots.assign(old.empty() ? 64 : old.size() * 2, NOT_FOUND);
+        for (uint32_t offset : old) {
+            if (offset != NOT_FOUND) slots[probe(view(offset))] = offset;
+        }
+    }
+
+public:
+    NameArena() { append(""); }
+
+    // Offset of name, adding it if it is new
+    uint32_t intern(string_view name) {
+        if (name.empty()) return 0;
+        if ((count + 1) * 2 > slots.size()) grow();
+        size_t slot = probe(name);
+        if (slots[slot] == NOT_FOUND) {
+            slots[slot] = append(name);
+            count++;
+        }
+        return slots[slot];
+    }
+
+    // Offset of name if it has been interned, otherwise NOT_FOUND
+    uint32_t find(string_view name) const {
+        if (name.empty()) return 0;
+        if (slots.empty()) return NOT_FOUND;
+        return slots[probe(name)];
+    }
+
+    string_view view(uint32_t offset) const {
+        uint32_t length;
+        memcpy(&length, &bytes[offset], sizeof(length));
+        return string_view(&bytes[offset + HEADER], length);
+    }
+
+    // NUL-terminated, for C-style APIs
+    const char* c_str(uint32_t offset) const { return &bytes[offset + HEADER]; }
+
+    // The owner's value for a name; -1 until set
+    int32_t tag(uint32_t offset) const {
+        int32_t value;
+        memcpy(&value, &bytes[offset + sizeof(uint32_t)], sizeof(value));
+        return value;
+    }
+
+    void setTag(uint32_t offset, int32_t value) { memcpy(&bytes[offset + sizeof(uint32_t)], &value, sizeof(value)); }
+
+    // Pre-size for a load of about this many names and characters
+    void reserve(size_t names, size_t characters) {
+        bytes.reserve(bytes.size() + characters + names * (HEADER + 1));
+        while ((count + names) * 2 > slots.size()) grow();
+    }
+
+    size_t sizeInBytes() const { return bytes.capacity() + slots.capacity() * sizeof(uint32_t); }
+};
+
+#endif // NAME_ARENA_H
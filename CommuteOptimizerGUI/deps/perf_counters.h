@@ -0,0 +1,183 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Hardware event counts for a stretch of user-space code; -1 where a counter was not available
+struct HardwareCounts {
+    bool measured = false;
+    long long cycles = -1;
+    long long instructions = -1;
+    long long cache_references = -1;
+    long long cache_misses = -1;
+    long long branches = -1;
+    long long branch_misses = -1;
+
+    // Add another stretch; a counter missing from either side stays missing
+    void add(const HardwareCounts& other) {
+        if (!other.measured) return;
+        if (!measured) {
+            *this = other;
+            return;
+        }
+        long long HardwareCounts::*fields[] = {&HardwareCounts::cycles, &HardwareCounts::instructions,
+                                               &HardwareCounts::cache_references, &HardwareCounts::cache_misses,
+                                               &HardwareCounts::branches, &HardwareCounts::branch_misses};
+        for (long long HardwareCounts::*field : fields) {
+            this->*field = (this->*field < 0 || other.*field < 0) ? -1 : this->*field + other.*field;
+        }
+    }
+
+    double ipc() const { return cycles > 0 && instructions >= 0 ? static_cast<double>(instructions) / cycles : 0.0; }
+
+    string summary() const {
+        ostringstream out;
+        if (instructions >= 0 && cycles > 0) out << ipc() << " IPC, ";
+        if (cache_misses >= 0) out << cache_misses << " cache misses";
+        if (cache_misses >= 0 && cache_references > 0) out << " (" << 100.0 * cache_misses / cache_references << "%)";
+        if (branch_misses >= 0) out << (cache_misses >= 0 ? ", " : "") << branch_misses << " branch misses";
+        if (branch_misses >= 0 && branches > 0) out << " (" << 100.0 * branch_misses / branches << "%)";
+        return out.str();
+    }
+};
+
+// Cycles, instructions, cache and branch events of the calling thread through Linux perf_event_open.
+//
+// The counters are opened once as a group, so they are switched on and off together and read in
+// one call; counters the machine lacks are left out of the group rather than failing it. When
+// nothing can be opened (no PMU in most VMs and containers, perf_event_paranoid too strict, or not
+// Linux) available() is false, unavailableReason() says why, and stop() returns unmeasured counts.
+// A PerfCounters counts only the thread that created it; forThisThread() keeps one per thread.
+// Nested start()/stop() pairs count once: only the outermost pair reads the counters.
+class PerfCounters {
+private:
+    int leader_fd = -1;
+    vector<int> fds;                                // Group members, leader first
+    vector<long long HardwareCounts::*> fields;     // Where each member's count goes
+    string failure;
+    int depth = 0;                                  // Open start() calls
+
+#ifdef __linux__
+    static int openEvent(uint64_t config, int group_fd) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = config;
+        attr.disabled = group_fd == -1 ? 1 : 0;     // The leader starts the whole group
+        attr.exclude_kernel = 1;                    // Allowed at the default perf_event_paranoid of 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+    }
+
+    static string describeFailure(int error) {
+        switch (error) {
+        case ENOENT:
+        case ENODEV:
+        case EOPNOTSUPP:
+            return "no hardware counters on this machine (common in virtual machines and containers)";
+        case EACCES:
+        case EPERM:
+            return "not permitted; lower /proc/sys/kernel/perf_event_paranoid or grant CAP_PERFMON";
+        case ENOSYS:
+            return "this kernel has no perf_event_open";
+        default:
+            return string("perf_event_open failed: ") + strerror(error);
+        }
+    }
+#endif
+
+public:
+    PerfCounters() {
+#ifdef __linux__
+        const pair<uint64_t, long long HardwareCounts::*> events[] = {
+            {PERF_COUNT_HW_CPU_CYCLES, &HardwareCounts::cycles},
+            {PERF_COUNT_HW_INSTRUCTIONS, &HardwareCounts::instructions},
+            {PERF_COUNT_HW_CACHE_REFERENCES, &HardwareCounts::cache_references},
+            {PERF_COUNT_HW_CACHE_MISSES, &HardwareCounts::cache_misses},
+            {PERF_COUNT_HW_BRANCH_INSTRUCTIONS, &HardwareCounts::branches},
+            {PERF_COUNT_HW_BRANCH_MISSES, &HardwareCounts::branch_misses},
+        };
+        int first_error = 0;
+        for (const auto& event : events) {
+            int fd = openEvent(event.first, leader_fd);
+            if (fd == -1) {
+                if (first_error == 0) first_error = errno;
+                continue;
+            }
+            if (leader_fd == -1) leader_fd = fd;
+            fds.push_back(fd);
+            fields.push_back(event.second);
+        }
+        if (leader_fd == -1) failure = describeFailure(first_error);
+#else
+        failure = "hardware counters need Linux perf_event_open";
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds) close(fd);
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const { return leader_fd != -1; }
+    const string& unavailableReason() const { return failure; }
+
+    // The calling thread's counters, opened on first use
+    static PerfCounters& forThisThread() {
+        static thread_local PerfCounters counters;
+        return counters;
+    }
+
+    // Zero the counters and start counting
+    void start() {
+#ifdef __linux__
+        if (leader_fd == -1 || depth++ > 0) return;
+        ioctl(leader_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    // Stop counting and return what was counted since start(), scaled up if the kernel had to
+    // share the hardware with other groups part of the time
+    HardwareCounts stop() {
+        HardwareCounts counts;
+#ifdef __linux__
+        if (leader_fd == -1 || --depth > 0) return counts;
+        ioctl(leader_fd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        uint64_t values[3 + 6];     // Member count, time enabled, time running, then the counts
+        ssize_t bytes = read(leader_fd, values, sizeof(values));
+        if (bytes < static_cast<ssize_t>(3 * sizeof(uint64_t)) || values[0] != fds.size() || values[2] == 0) {
+            return counts;
+        }
+        double scale = static_cast<double>(values[1]) / values[2];
+        for (size_t i = 0; i < fields.size(); i++) {
+            counts.*fields[i] = static_cast<long long>(values[3 + i] * scale + 0.5);
+        }
+        counts.measured = true;
+#endif
+        return counts;
+    }
+};
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,186 @@
+#ifndef QUERY_LOG_H
+#define QUERY_LOG_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// What a logged query ran. Values are stored in the file, so never renumber them.
+enum QueryAlgorithm : uint16_t {
+    QUERY_DIJKSTRA = 1,
+    QUERY_BFS = 2,
+    QUERY_PARETO = 3,
+    QUERY_KSP = 4,              // param[0] = k
+    QUERY_ALTERNATIVES = 5,     // param[0] = AlternativeMethod
+    QUERY_ISOCHRONE = 6,        // start = centre, see QueryLog::recordIsochrone
+    QUERY_RAPTOR = 7,           // param = departure, max transfers
+    QUERY_RAPTOR_RANGE = 8,     // param = window start, window end, max transfers
+    QUERY_CSA = 9,              // param[0] = departure
+    QUERY_CSA_PROFILE = 10,     // param = window start, window end
+};
+
+// One query as the frontends ran it
+struct LoggedQuery {
+    int64_t timestamp_us = 0;   // Wall clock, microseconds since the Unix epoch
+    QueryAlgorithm algorithm = QUERY_DIJKSTRA;
+    uint16_t limit_count = 0;   // QUERY_ISOCHRONE: time limits asked for; 0 in logs that predate it
+    int32_t start_id = -1;
+    int32_t end_id = -1;        // -1 when the algorithm has no destination
+    int32_t param[3] = {0, 0, 0};
+};
+
+inline const char* queryAlgorithmName(QueryAlgorithm algorithm) {
+    switch (algorithm) {
+    case QUERY_DIJKSTRA: return "Dijkstra";
+    case QUERY_BFS: return "BFS";
+    case QUERY_PARETO: return "Pareto";
+    case QUERY_KSP: return "k-shortest";
+    case QUERY_ALTERNATIVES: return "Alternatives";
+    case QUERY_ISOCHRONE: return "Isochrone";
+    case QUERY_RAPTOR: return "RAPTOR";
+    case QUERY_RAPTOR_RANGE: return "RAPTOR range";
+    case QUERY_CSA: return "CSA";
+    case QUERY_CSA_PROFILE: return "CSA profile";
+    }
+    return "unknown";
+}
+
+// Binary query log: an 8-byte magic, then one 32-byte little-endian record per query
+//   int64 timestamp_us, uint16 algorithm, uint16 limit_count, int32 start_id, int32 end_id, int32 param[3]
+// limit_count is 0 for every algorithm but QUERY_ISOCHRONE.
+// Records are appended and flushed one at a time, so a crash loses at most the query in flight
+// and a log can be extended across runs.
+class QueryLog {
+private:
+    static constexpr char MAGIC[8] = {'C', 'Q', 'L', 'O', 'G', '0', '0', '1'};
+    static const size_t RECORD_SIZE = 32;
+
+    mutex write_mutex;
+    ofstream out;
+
+    static void put(unsigned char* at, uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) at[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+
+    static uint64_t get(const unsigned char* at, int bytes) {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; i++) value |= static_cast<uint64_t>(at[i]) << (8 * i);
+        return value;
+    }
+
+    void write(QueryAlgorithm algorithm, int limit_count, int start_id, int end_id, int param0, int param1, int param2) {
+        if (!isOpen()) return;
+        int64_t now = chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+        unsigned char bytes[RECORD_SIZE];
+        put(bytes, static_cast<uint64_t>(now), 8);
+        put(bytes + 8, algorithm, 2);
+        put(bytes + 10, static_cast<uint16_t>(limit_count), 2);
+        put(bytes + 12, static_cast<uint32_t>(start_id), 4);
+        put(bytes + 16, static_cast<uint32_t>(end_id), 4);
+        put(bytes + 20, static_cast<uint32_t>(param0), 4);
+        put(bytes + 24, static_cast<uint32_t>(param1), 4);
+        put(bytes + 28, static_cast<uint32_t>(param2), 4);
+        lock_guard<mutex> lock(write_mutex);
+        out.write(reinterpret_cast<const char*>(bytes), RECORD_SIZE);
+        out.flush();
+    }
+
+    static int32_t floatBits(float value) {
+        int32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    static float bitsFloat(int32_t bits) {
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+public:
+    // Append to filename, writing the magic first if the file is new or empty
+    bool open(const string& filename) {
+        lock_guard<mutex> lock(write_mutex);
+        out.open(filename, ios::binary | ios::app);
+        if (!out.is_open()) {
+            cerr << "Error: Could not open query log for writing: '" << filename << "'" << endl;
+            return false;
+        }
+        out.seekp(0, ios::end);
+        if (out.tellp() == 0) out.write(MAGIC, sizeof(MAGIC));
+        return true;
+    }
+
+    // Log to the file named by COMMUTE_QUERY_LOG, if set
+    bool openFromEnvironment() {
+        const char* filename = getenv("COMMUTE_QUERY_LOG");
+        if (!filename || !*filename) return false;
+        return open(filename);
+    }
+
+    bool isOpen() const { return out.is_open(); }
+
+    // Safe from any thread; does nothing unless a log is open
+    void record(QueryAlgorithm algorithm, int start_id, int end_id, int param0 = 0, int param1 = 0, int param2 = 0) {
+        write(algorithm, 0, start_id, end_id, param0, param1, param2);
+    }
+
+    // An isochrone keeps how many time limits it had and the three largest as floats in param,
+    // largest first. The largest limit sets how far the search runs, so a replay of a query with
+    // more than three limits does the same work and only buckets its answer more coarsely.
+    void recordIsochrone(int centre_id, vector<double> limits) {
+        sort(limits.rbegin(), limits.rend());
+        int32_t param[3] = {0, 0, 0};
+        for (size_t i = 0; i < limits.size() && i < 3; i++) param[i] = floatBits(static_cast<float>(limits[i]));
+        write(QUERY_ISOCHRONE, static_cast<int>(min<size_t>(limits.size(), 0xFFFF)), centre_id, -1, param[0], param[1], param[2]);
+    }
+
+    // The time limits a logged isochrone is replayed with. Logs written before limit_count existed
+    // hold only the largest limit, rounded up to whole minutes, in param[0].
+    static vector<double> isochroneLimits(const LoggedQuery& query) {
+        if (query.limit_count == 0) return {static_cast<double>(query.param[0])};
+        vector<double> limits;
+        for (int i = 0; i < query.limit_count && i < 3; i++) limits.push_back(bitsFloat(query.param[i]));
+        return limits;
+    }
+
+    // Every record of a log file, in the order written
+    static bool read(const string& filename, vector<LoggedQuery>& queries) {
+        ifstream in(filename, ios::binary);
+        if (!in.is_open()) {
+            cerr << "Error: Could not open query log '" << filename << "'" << endl;
+            return false;
+        }
+        char magic[sizeof(MAGIC)];
+        if (!in.read(magic, sizeof(magic)) || !equal(magic, magic + sizeof(magic), MAGIC)) {
+            cerr << "Error: '" << filename << "' is not a query log." << endl;
+            return false;
+        }
+        unsigned char bytes[RECORD_SIZE];
+        while (in.read(reinterpret_cast<char*>(bytes), RECORD_SIZE)) {
+            LoggedQuery query;
+            query.timestamp_us = static_cast<int64_t>(get(bytes, 8));
+            query.algorithm = static_cast<QueryAlgorithm>(get(bytes + 8, 2));
+            query.limit_count = static_cast<uint16_t>(get(bytes + 10, 2));
+            query.start_id = static_cast<int32_t>(get(bytes + 12, 4));
+            query.end_id = static_cast<int32_t>(get(bytes + 16, 4));
+            for (int i = 0; i < 3; i++) query.param[i] = static_cast<int32_t>(get(bytes + 20 + 4 * i, 4));
+            queries.push_back(query);
+        }
+        if (in.gcount() != 0) {
+            cerr << "Warning: Query log '" << filename << "' ends in a partial record; it was ignored." << endl;
+        }
+        return true;
+    }
+};
+
+#endif // QUERY_LOG_H
@@ -0,0 +1,85 @@
+#ifndef SEARCH_WORKSPACE_H
+#define SEARCH_WORKSPACE_H
+
+#include <algorithm>
+#include <vector>
+#include <functional>
+#include "graphV1.h"
+
+using namespace std;
+
+// Reusable scratch space for repeated shortest-path searches.
+// Instead of refilling distance arrays before every search, each entry carries the generation
+// that last wrote it; bumping the generation invalidates everything in O(1). The heap keeps its
+// capacity too, so back-to-back searches stop allocating once the workspace has warmed up.
+// One workspace per thread. Weight is the distance type, the graph's weight type.
+template <class Weight>
+class BasicSearchWorkspace {
+private:
+    vector<Weight> dist;
+    vector<int> parent;
+    vector<unsigned> stamp;         // Generation that wrote dist/parent
+    vector<unsigned> settled_stamp; // Generation that settled the node
+    vector<unsigned> banned_stamp;  // Ban generation that excluded the node
+    unsigned generation = 0;
+    unsigned ban_generation = 1;
+
+public:
+    typedef pair<Weight, int> HeapEntry;
+    vector<HeapEntry> heap;         // Min-heap through push_heap/pop_heap with greater<>
+
+    // Start a new search over n nodes
+    void prepare(int n) {
+        if (static_cast<int>(dist.size()) < n) {
+            dist.resize(n);
+            parent.resize(n);
+            stamp.resize(n, 0);
+            settled_stamp.resize(n, 0);
+            banned_stamp.resize(n, 0);
+        }
+        if (++generation == 0) { // Wrapped around: old stamps could look current
+            fill(stamp.begin(), stamp.end(), 0);
+            fill(settled_stamp.begin(), settled_stamp.end(), 0);
+            generation = 1;
+        }
+        heap.clear();
+    }
+
+    Weight distance(int v) const { return stamp[v] == generation ? dist[v] : unreachableWeight<Weight>(); }
+    int previous(int v) const { return stamp[v] == generation ? parent[v] : -1; }
+
+    void update(int v, Weight d, int from) {
+        stamp[v] = generation;
+        dist[v] = d;
+        parent[v] = from;
+    }
+
+    bool isSettled(int v) const { return settled_stamp[v] == generation; }
+    void settle(int v) { settled_stamp[v] = generation; }
+
+    void push(Weight key, int v) {
+        heap.push_back({key, v});
+        push_heap(heap.begin(), heap.end(), greater<HeapEntry>());
+    }
+
+    HeapEntry pop() {
+        pop_heap(heap.begin(), heap.end(), greater<HeapEntry>());
+        HeapEntry top = heap.back();
+        heap.pop_back();
+        return top;
+    }
+
+    // Node bans survive prepare() so one ban set can serve several searches
+    void clearBans() {
+        if (++ban_generation == 0) {
+            fill(banned_stamp.begin(), banned_stamp.end(), 0);
+            ban_generation = 1;
+        }
+    }
+    void ban(int v) { banned_stamp[v] = ban_generation; }
+    bool isBanned(int v) const { return banned_stamp[v] == ban_generation; }
+};
+
+typedef BasicSearchWorkspace<double> SearchWorkspace;
+
+#endif // SEARCH_WORKSPACE_H
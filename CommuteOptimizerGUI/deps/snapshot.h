@@ -0,0 +1,168 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include "graphV1.h"
+
+using namespace std;
+
+// Versioned, immutable graph snapshots (read-copy-update).
+//
+// Readers pin the current version with read() and search it without taking any lock; the
+// version they hold never changes underneath them. Writers queue edits, and publish() applies
+// the whole batch to a private copy and swaps it in with one atomic pointer store.
+//
+// Old versions are reclaimed by epochs: a reader announces the global epoch in a slot before
+// loading the pointer, and a version retired at epoch e is freed once no slot still shows an
+// epoch <= e. Readers only ever touch their own slot, so they never wait for writers or each other.
+//
+// A freed version's memory can come back as a later version at the same address, so code caching
+// per-version state should compare ReadGuard::version(), never the graph pointer.
+class GraphStore {
+private:
+    static const int MAX_READERS = 128;      // Concurrent read guards (threads x nesting)
+
+    struct alignas(64) ReaderSlot {          // One cache line each so readers do not share lines
+        atomic<unsigned long long> epoch;    // 0 = free, otherwise the epoch the reader entered in
+    };
+
+    // A published graph with its version number, swapped in and retired as one
+    struct Snapshot {
+        Graph graph;
+        unsigned long long version;
+    };
+
+    struct RetiredVersion {
+        const Snapshot* snapshot;
+        unsigned long long epoch;
+    };
+
+    atomic<const Snapshot*> current;
+    atomic<unsigned long long> global_epoch;
+    atomic<unsigned long long> published_version;
+    ReaderSlot slots[MAX_READERS];
+
+    mutex writer_mutex;                      // Serialises writers only
+    vector<function<void(Graph&)>> pending_edits;
+    vector<RetiredVersion> retired;
+
+    int enter() {
+        // Start from a per-thread hint so threads rarely probe the same slots
+        static thread_local int hint = static_cast<int>(hash<thread::id>()(this_thread::get_id()) % MAX_READERS);
+        while (true) {
+            for (int i = 0; i < MAX_READERS; i++) {
+                int slot = (hint + i) % MAX_READERS;
+                unsigned long long expected = 0;
+                if (slots[slot].epoch.compare_exchange_strong(expected, global_epoch.load())) {
+                    hint = slot;
+                    return slot;
+                }
+            }
+            this_thread::yield(); // Every slot busy: more readers than MAX_READERS
+        }
+    }
+
+    void leave(int slot) { slots[slot].epoch.store(0); }
+
+    // Free retired versions that no reader can still hold. Caller holds writer_mutex.
+    void reclaim() {
+        unsigned long long oldest_reader = ~0ULL;
+        for (int i = 0; i < MAX_READERS; i++) {
+            unsigned long long epoch = slots[i].epoch.load();
+            if (epoch != 0 && epoch < oldest_reader) oldest_reader = epoch;
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < retired.size(); i++) {
+            if (retired[i].epoch < oldest_reader) {
+                delete retired[i].snapshot;
+            } else {
+                retired[kept++] = retired[i];
+            }
+        }
+        retired.resize(kept);
+    }
+
+public:
+    // A pinned version; the graph stays valid until the guard goes out of scope
+    class ReadGuard {
+    private:
+        GraphStore* store;
+        int slot;
+        const Snapshot* snapshot;
+
+    public:
+        ReadGuard(GraphStore* s) : store(s), slot(s->enter()), snapshot(s->current.load()) {}
+        ReadGuard(ReadGuard&& other) : store(other.store), slot(other.slot), snapshot(other.snapshot) { other.slot = -1; }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ~ReadGuard() {
+            if (slot != -1) store->leave(slot);
+        }
+
+        const Graph& operator*() const { return snapshot->graph; }
+        const Graph* operator->() const { return &snapshot->graph; }
+        const Graph* get() const { return &snapshot->graph; }
+        // Version number of the pinned graph; unlike its address, never reused
+        unsigned long long version() const { return snapshot->version; }
+    };
+
+    // Takes ownership of the initial graph contents
+    GraphStore(Graph initial = Graph()) : current(new Snapshot{move(initial), 1}), global_epoch(1), published_version(1) {
+        for (int i = 0; i < MAX_READERS; i++) slots[i].epoch.store(0);
+    }
+
+    GraphStore(const GraphStore&) = delete;
+    GraphStore& operator=(const GraphStore&) = delete;
+
+    ~GraphStore() {
+        for (const RetiredVersion& version : retired) delete version.snapshot;
+        delete current.load();
+    }
+
+    ReadGuard read() { return ReadGuard(this); }
+
+    // Version number of the latest published snapshot
+    unsigned long long version() const { return published_version.load(); }
+
+    // Queue a change for the next version; it becomes visible at publish()
+    void queueEdit(function<void(Graph&)> edit) {
+        lock_guard<mutex> lock(writer_mutex);
+        pending_edits.push_back(move(edit));
+    }
+
+    bool hasPendingEdits() {
+        lock_guard<mutex> lock(writer_mutex);
+        return !pending_edits.empty();
+    }
+
+    // Apply every queued edit to a copy of the current version and publish it.
+    // Returns the new version number, or the current one if nothing was queued.
+    unsigned long long publish() {
+        TraceSpan span("publish snapshot", "edit");
+        lock_guard<mutex> lock(writer_mutex);
+        if (pending_edits.empty()) {
+            reclaim();
+            return published_version.load();
+        }
+
+        const Snapshot* old_snapshot = current.load();
+        Snapshot* next = new Snapshot{old_snapshot->graph, old_snapshot->version + 1};
+        for (function<void(Graph&)>& edit : pending_edits) {
+            edit(next->graph);
+        }
+        pending_edits.clear();
+
+        current.store(next);
+        published_version.store(next->version);
+        // Readers entering from now on see the new epoch and therefore the new pointer
+        retired.push_back(RetiredVersion{old_snapshot, global_epoch.fetch_add(1)});
+        reclaim();
+        return next->version;
+    }
+};
+
+#endif // SNAPSHOT_H
@@ -1,406 +1,934 @@
-#include <iostream>
-#include <fstream>
-#include <string>
-#include <vector>
-#include <unordered_map>
-#include <limits>
-#include <sstream>
-#include <stdio.h>
-#include <iomanip> // Needed for std::fixed and std::setprecision
-
-// Your graph and map headers
-#include "graphV1.h"
-#include "map.h"
-
-// ImGui and its backends
-#include <glad/glad.h>
-#include <GLFW/glfw3.h>
-#include <imgui.h>
-#include <imgui_impl_glfw.h>
-#include <imgui_impl_opengl3.h>
-#include <imgui_internal.h> // For ImGui::GetWindowDrawList() if not already included implicitly
-
-// Define these flags at the top for ImGui features
-#define ImGuiConfigFlags_DockingEnable          (1 << 20)
-// Removed: #define ImGuiConfigFlags_ViewportsEnable        (1 << 10)
-
-// Use namespace std to avoid std:: prefixes
-using namespace std;
-
-
-// Global or accessible objects for graph and map data
-Graph bus_network;
-Map* map_instance = nullptr;
-
-// Buffers for ImGui text input
-char start_location_input[256] = "";
-
-// Buffers for displaying path details
-string path_display_text = "No path calculated yet.";
-string add_data_status_text = ""; // To display status of add operations
-
-
-// displayPathDetails now updates a string for GUI display
-void displayPathDetails(const PathDetails& path, Graph* graph) {
-    ostringstream oss;
-
-    oss << "--- Route Details ---" << endl;
-    if (!path.path_exists) {
-        oss << "No path found." << endl;
-        path_display_text = oss.str();
-        return;
-    }
-
-    oss << "Path: ";
-    bool is_first_node = true;
-    for (int current_node_id : path.node_ids_in_path) {
-        if (!is_first_node) {
-            oss << " -> ";
-        }
-        oss << graph->getNode(current_node_id).name;
-        is_first_node = false;
-    }
-    oss << endl;
-
-    if (path.num_stops != -1) {
-        oss << "Number of stops (segments): " << path.num_stops << endl;
-    }
-    if (path.total_weight != DOUBLE_INF) {
-        oss << "Total cost (time/distance): " << path.total_weight << endl;
-    }
-    oss << "---------------------\n" << endl;
-
-    path_display_text = oss.str();
-}
-
-// Function to append a new node to the nodes file
-void appendNodeToFile(const Node& node, const string& filename) {
-    ofstream outFile(filename, ios::app);
-    if (!outFile.is_open()) {
-        // Corrected string concatenation using '+'
-        add_data_status_text = "Error: Could not open nodes file for appending: '" + filename + "'";
-        return;
-    }
-    outFile << endl << node.id << " " << node.name; // Output to file with endl
-    outFile.close();
-    // Corrected string concatenation using '+'
-    add_data_status_text = "Node '" + node.name + "' appended to " + filename;
-}
-
-// Function to append a new edge to the edges file
-void appendEdgeToFile(int source_id, int dest_id, double weight, const string& filename) {
-    ofstream outFile(filename, ios::app);
-    if (!outFile.is_open()) {
-        // Corrected string concatenation using '+'
-        add_data_status_text = "Error: Could not open edges file for appending: '" + filename + "'";
-        return;
-    }
-    outFile << endl << source_id << " " << dest_id << " " << fixed << setprecision(1) << weight; // Output to file with endl
-    outFile.close();
-    // Corrected string concatenation using '+'
-    add_data_status_text = "Edge " + to_string(source_id) + " " + to_string(dest_id) + " " + to_string(weight) + " appended to " + filename;
-}
-
-// Global char buffers for add data inputs
-char new_location_name_input[256] = "";
-char source_name_input[256] = "";
-char dest_name_input[256] = "";
-float new_weight_input = 0.0f;
-
-void handleAddDataGUI(Graph& graph, const string& nodes_filename, const string& edges_filename) {
-    // This function will be called within an ImGui::Begin/End block
-    ImGui::Text("Add New Location or Route:");
-    ImGui::Separator();
-
-    // Add New Location (Node)
-    ImGui::Text("Add New Location:");
-    ImGui::InputText("##NewLocationName", new_location_name_input, IM_ARRAYSIZE(new_location_name_input));
-    ImGui::SameLine();
-    if (ImGui::Button("Add Location")) {
-        string new_location_name_str(new_location_name_input);
-        if (new_location_name_str.empty()) {
-            add_data_status_text = "Error: Location name cannot be empty.";
-        } else if (graph.getNodeIndexByname(new_location_name_str) != -1) {
-            add_data_status_text = "Error: Location '" + new_location_name_str + "' already exists.";
-        } else {
-            int new_node_id = graph.getNumNodes();
-            graph.addNode(new_node_id, new_location_name_str);
-            appendNodeToFile(graph.getNode(new_node_id), nodes_filename); // Persist
-            add_data_status_text = "Successfully added new location: " + new_location_name_str + " (ID: " + to_string(new_node_id) + ")";
-            new_location_name_input[0] = '\0'; // Clear input field
-        }
-    }
-
-    ImGui::Spacing();
-    ImGui::Separator();
-
-    // Add New Route (Edge)
-    ImGui::Text("Add New Route:");
-    ImGui::InputText("Source Name", source_name_input, IM_ARRAYSIZE(source_name_input));
-    ImGui::InputText("Destination Name", dest_name_input, IM_ARRAYSIZE(dest_name_input));
-    ImGui::InputFloat("Weight", &new_weight_input, 0.1f, 1.0f, "%.1f"); // For float input
-
-    if (ImGui::Button("Add Route")) {
-        string source_name_str(source_name_input);
-        string dest_name_str(dest_name_input);
-
-        int source_id = graph.getNodeIndexByname(source_name_str);
-        if (source_id == -1) {
-            add_data_status_text = "Error: Source location '" + source_name_str + "' not found.";
-        } else {
-            int dest_id = graph.getNodeIndexByname(dest_name_str);
-            if (dest_id == -1) {
-                add_data_status_text = "Error: Destination location '" + dest_name_str + "' not found.";
-            } else if (source_id == dest_id) {
-                add_data_status_text = "Error: Cannot add route to itself.";
-            } else if (new_weight_input < 0) {
-                 add_data_status_text = "Error: Weight cannot be negative.";
-            }
-            else {
-                try {
-                    graph.addEdge(source_id, dest_id, new_weight_input);
-                    appendEdgeToFile(source_id, dest_id, new_weight_input, edges_filename); // Persist
-                    add_data_status_text = "Successfully added route between " + source_name_str + " and " + dest_name_str + " with weight " + to_string(new_weight_input);
-                    source_name_input[0] = '\0'; // Clear input fields
-                    dest_name_input[0] = '\0';
-                    new_weight_input = 0.0f;
-                } catch (const out_of_range& e) {
-                    add_data_status_text = "Error adding edge: " + string(e.what());
-                }
-            }
-        }
-    }
-    ImGui::TextWrapped("Status: %s", add_data_status_text.c_str());
-}
-
-
-// Function to handle GLFW errors
-void glfw_error_callback(int error, const char* description) {
-    fprintf(stderr, "GLFW Error %d: %s\n", error, description);
-}
-
-int main() {
-    // 1. Initialize GLFW
-    glfwSetErrorCallback(glfw_error_callback);
-    if (!glfwInit()) {
-        cerr << "Failed to initialize GLFW!" << endl;
-        return 1;
-    }
-
-    // 2. Configure OpenGL Context (for ImGui OpenGL3 backend)
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    glfwWindowHint(GLFW_MAXIMIZED, GLFW_TRUE);
-
-    // 3. Create a GLFW window
-    GLFWwindow* window = glfwCreateWindow(1280, 720, "Commute Optimizer GUI", NULL, NULL);
-    if (window == NULL) {
-        cerr << "Failed to create GLFW window!" << endl;
-        glfwTerminate();
-        return 1;
-    }
-    glfwMakeContextCurrent(window);
-    glfwSwapInterval(1);
-
-    // 4. Load OpenGL functions using GLAD
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-        cerr << "Failed to initialize GLAD!" << endl;
-        glfwTerminate();
-        return 1;
-    }
-
-    // 5. Setup ImGui context
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    ImGuiIO& io = ImGui::GetIO(); (void)io;
-    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
-    io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;
-    io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
-
-    // 6. Setup ImGui style (more customization options)
-    ImGui::StyleColorsDark();
-    ImGuiStyle& style = ImGui::GetStyle();
-    // Example: Make window background slightly transparent for a cooler look
-    style.Colors[ImGuiCol_WindowBg].w = 0.9f;
-    // Example: Change button colors
-    style.Colors[ImGuiCol_Button] = ImVec4(0.26f, 0.59f, 0.98f, 0.40f);
-    style.Colors[ImGuiCol_ButtonHovered] = ImVec4(0.26f, 0.59f, 0.98f, 1.00f);
-    style.Colors[ImGuiCol_ButtonActive] = ImVec4(0.06f, 0.53f, 0.98f, 1.00f);
-
-    // 7. Setup Platform/Renderer backends
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
-    ImGui_ImplOpenGL3_Init("#version 330");
-
-
-    // --- File loading UI and logic ---
-    bool map_loaded = false;
-    char nodes_filename_buffer[256] = "nodes.txt";
-    char edges_filename_buffer[256] = "edges.txt";
-
-    while (!map_loaded && !glfwWindowShouldClose(window)) {
-        glfwPollEvents();
-
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
-
-        ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x * 0.5f, ImGui::GetIO().DisplaySize.y * 0.5f), ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
-        ImGui::Begin("Load Map Files", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoMove);
-        ImGui::Text("Please enter map filenames:");
-        ImGui::InputText("Nodes File", nodes_filename_buffer, IM_ARRAYSIZE(nodes_filename_buffer));
-        ImGui::InputText("Edges File", edges_filename_buffer, IM_ARRAYSIZE(edges_filename_buffer));
-
-        if (ImGui::Button("Load Map")) {
-            if (map_instance) delete map_instance;
-            map_instance = new Map(nodes_filename_buffer, edges_filename_buffer);
-
-            if (map_instance->map_to_graph(bus_network)) {
-                map_loaded = true;
-                cout << "Map loaded successfully for GUI." << endl;
-            } else {
-                cerr << "Failed to load map. Check filenames." << endl;
-                delete map_instance;
-                map_instance = nullptr;
-            }
-        }
-        ImGui::End();
-
-        ImGui::Render();
-        int display_w, display_h;
-        glfwGetFramebufferSize(window, &display_w, &display_h);
-        glViewport(0, 0, display_w, display_h);
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        glfwSwapBuffers(window);
-    }
-
-    if (!map_loaded) {
-        if (map_instance) {
-            delete map_instance;
-            map_instance = nullptr;
-        }
-        ImGui_ImplOpenGL3_Shutdown();
-        ImGui_ImplGlfw_Shutdown();
-        ImGui::DestroyContext();
-        glfwDestroyWindow(window);
-        glfwTerminate();
-        return 1;
-    }
-
-
-    // Main GUI loop
-    ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
-    const int UNIVERSITY_NODE_ID = 0;
-
-    while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
-
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
-
-        // 8. Main Commute Optimizer UI
-        ImGui::Begin("University Commute Optimizer", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
-
-        // --- Header Section with Colors/Shapes ---
-        ImGui::TextColored(ImVec4(0.8f, 0.2f, 0.2f, 1.0f), "Welcome to Your Commute Optimizer!");
-        ImGui::SameLine(0.0f, ImGui::GetContentRegionAvail().x - 120);
-        ImGui::TextDisabled("v1.0.0");
-
-        ImGui::Dummy(ImVec2(0.0f, 5.0f));
-        ImDrawList* draw_list = ImGui::GetWindowDrawList();
-        ImVec2 p = ImGui::GetCursorScreenPos();
-        draw_list->AddRectFilled(p, ImVec2(p.x + ImGui::GetContentRegionAvail().x, p.y + 3.0f), ImU32(IM_COL32(0, 100, 150, 255)));
-        ImGui::Dummy(ImVec2(0.0f, 5.0f));
-
-        ImGui::Text("Destination: %s (ID: %d)", map_instance->getUniversityName().c_str(), UNIVERSITY_NODE_ID);
-        ImGui::Separator();
-
-        // --- Route Finding Section ---
-        ImGui::Text("Find Your Route:");
-        ImGui::InputText("##StartLoc", start_location_input, IM_ARRAYSIZE(start_location_input));
-        ImGui::SetItemTooltip("Enter your starting location name here.");
-
-        ImGui::Spacing();
-
-        ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.2f, 0.6f, 0.2f, 1.0f));
-        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.3f, 0.7f, 0.3f, 1.0f));
-        ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.1f, 0.5f, 0.1f, 1.0f));
-        if (ImGui::Button("Find Fastest Route (Dijkstra)", ImVec2(200, 30))) {
-            string start_stop_name(start_location_input);
-            int start_node_id = bus_network.getNodeIndexByname(start_stop_name);
-            if (start_node_id != -1) {
-                displayPathDetails(bus_network.Dijkstra(start_node_id, UNIVERSITY_NODE_ID), &bus_network);
-            } else {
-                path_display_text = "Error: Starting location '" + start_stop_name + "' not found in the map.";
-            }
-        }
-        ImGui::PopStyleColor(3);
-
-        ImGui::SameLine(0.0f, 10.0f);
-
-        ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.8f, 0.4f, 0.1f, 1.0f));
-        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.9f, 0.5f, 0.2f, 1.0f));
-        ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.7f, 0.3f, 0.0f, 1.0f));
-        if (ImGui::Button("Find Minimum Stops (BFS)", ImVec2(200, 30))) {
-            string start_stop_name(start_location_input);
-            int start_node_id = bus_network.getNodeIndexByname(start_stop_name);
-            if (start_node_id != -1) {
-                displayPathDetails(bus_network.BFS(start_node_id, UNIVERSITY_NODE_ID), &bus_network);
-            } else {
-                path_display_text = "Error: Starting location '" + start_stop_name + "' not found in the map.";
-            }
-        }
-        ImGui::PopStyleColor(3);
-
-        ImGui::Separator();
-        ImGui::Text("Route Details:");
-        ImGui::TextWrapped("%s", path_display_text.c_str());
-
-        ImGui::Spacing();
-        ImGui::Separator();
-
-        // --- Add New Data Section ---
-        handleAddDataGUI(bus_network, nodes_filename_buffer, edges_filename_buffer);
-
-        ImGui::Spacing();
-        ImGui::Separator();
-
-        // --- Exit Button ---
-        ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.7f, 0.1f, 0.1f, 1.0f));
-        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.8f, 0.2f, 0.2f, 1.0f));
-        ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.6f, 0.0f, 0.0f, 1.0f));
-        if (ImGui::Button("Exit", ImVec2(ImGui::GetContentRegionAvail().x, 30))) {
-            glfwSetWindowShouldClose(window, true);
-        }
-        ImGui::PopStyleColor(3);
-
-        ImGui::End(); // End Main Commute Optimizer window
-
-        // Rendering
-        ImGui::Render();
-        int display_w, display_h;
-        glfwGetFramebufferSize(window, &display_w, &display_h);
-        glViewport(0, 0, display_w, display_h);
-        glClearColor(clear_color.x * clear_color.w, clear_color.y * clear_color.w, clear_color.z * clear_color.w, clear_color.w);
-        glClear(GL_COLOR_BUFFER_BIT);
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-
-        glfwSwapBuffers(window);
-    }
-
-    // Cleanup
-    if (map_instance) {
-        delete map_instance;
-        map_instance = nullptr;
-    }
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
-    glfwDestroyWindow(window);
-    glfwTerminate();
-
-    return 0;
-}
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <limits>
+#include <sstream>
+#include <stdio.h>
+#include <iomanip> // Needed for std::fixed and std::setprecision
+#include <deque>
+#include <future>
+#include <functional>
+#include <chrono>
+#include <cmath>
+
+// Your graph and map headers
+#include "graphV1.h"
+#include "map.h"
+#include "timetable.h"
+#include "csa.h"
+#include "pareto.h"
+#include "ksp.h"
+#include "alternatives.h"
+#include "isochrone.h"
+#include "snapshot.h"
+#include "async_query.h"
+#include "map_view.h"
+#include "fuzzy_match.h"
+#include "latency_histogram.h"
+#include "query_log.h"
+
+// ImGui and its backends
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <imgui.h>
+#include <imgui_impl_glfw.h>
+#include <imgui_impl_opengl3.h>
+#include <imgui_internal.h> // For ImGui::GetWindowDrawList() if not already included implicitly
+
+// Define these flags at the top for ImGui features
+#define ImGuiConfigFlags_DockingEnable          (1 << 20)
+// Removed: #define ImGuiConfigFlags_ViewportsEnable        (1 << 10)
+
+// Use namespace std to avoid std:: prefixes
+using namespace std;
+
+
+// Global or accessible objects for graph and map data.
+// The loaded graph lives in a GraphStore: searches run on the QueryRunner thread against a pinned
+// snapshot, and edits publish a new version, so neither ever blocks the render loop.
+GraphStore* network_store = nullptr;
+QueryRunner* query_runner = nullptr;
+Map* map_instance = nullptr;
+
+// Optional bus timetable; when loaded, "Find Fastest Route" answers with the connection scan engine.
+// Only the QueryRunner thread uses the engine.
+Timetable timetable;
+ConnectionScanEngine* csa_engine = nullptr;
+
+// Buffers for ImGui text input
+char start_location_input[256] = "";
+char departure_time_input[16] = "07:00";
+char window_end_input[16] = "09:00";
+int backup_route_count = 5;
+int alternative_method = ALTERNATIVES_PLATEAU;
+char isochrone_limits_input[64] = "30 45 60";
+
+// Autocomplete for the start location: stops whose names begin with what has been typed
+const size_t MAX_START_SUGGESTIONS = 8;
+vector<string> start_suggestions;
+bool start_suggestions_hovered = false;
+
+// Spelling fallback for stop names; used only on the QueryRunner thread
+FuzzyNameMatcher stop_matcher;
+
+// Every search, when COMMUTE_QUERY_LOG names a file; written from the QueryRunner thread
+QueryLog query_log;
+
+// Buffers for displaying path details
+string path_display_text = "No path calculated yet.";
+string add_data_status_text = ""; // To display status of add operations
+
+// Results still being computed. Only the newest query is kept; older ones are dropped unread.
+future<QueryResult> route_result;
+string route_job_name;
+double route_job_started = 0.0;
+deque<future<QueryResult>> edit_results;
+
+// Instrumentation for panel searches, hardware counters included where the machine has them,
+// plus the check that lets a cancelled or replaced query stop early
+typedef CancellableSearchStats<PerfSearchStats> PanelSearchStats;
+SearchStats route_stats;    // Of the answer on show
+
+// Latency of every query by algorithm, recorded on the QueryRunner thread. A deque so entries
+// never move once a job holds a pointer to its histogram; only the render thread adds entries.
+struct QueryLatency {
+    string name;
+    LatencyHistogram histogram;
+    uint64_t count_at_sample = 0;   // For queries per second
+    double per_second = 0;
+};
+deque<QueryLatency> query_latencies;
+LatencyHistogram frame_times;
+double rate_sampled_at = 0.0;
+
+LatencyHistogram& queryLatency(const string& name) {
+    for (QueryLatency& entry : query_latencies) {
+        if (entry.name == name) return entry.histogram;
+    }
+    query_latencies.emplace_back();
+    query_latencies.back().name = name;
+    return query_latencies.back().histogram;
+}
+
+// Routes of the last answer, highlighted on the network map
+NetworkMapView network_map;
+vector<vector<int>> map_routes;
+unsigned long long map_routes_version = 0;
+
+// The map's layout is built on the QueryRunner thread, once per graph version
+future<QueryResult> map_layout_result;
+unsigned long long map_layout_requested = 0;
+
+
+// formatPathDetails builds the text shown under "Route Details"
+string formatPathDetails(const PathDetails& path, const Graph& graph) {
+    ostringstream oss;
+
+    oss << "--- Route Details ---" << endl;
+    if (!path.path_exists) {
+        oss << "No path found." << endl;
+        return oss.str();
+    }
+
+    oss << "Path: ";
+    bool is_first_node = true;
+    for (int current_node_id : path.node_ids_in_path) {
+        if (!is_first_node) {
+            oss << " -> ";
+        }
+        oss << graph.getNodeName(current_node_id);
+        is_first_node = false;
+    }
+    oss << endl;
+
+    if (path.num_stops != -1) {
+        oss << "Number of stops (segments): " << path.num_stops << endl;
+    }
+    if (path.total_weight != DOUBLE_INF) {
+        oss << "Total cost (time/distance): " << path.total_weight << endl;
+    }
+    oss << "---------------------\n" << endl;
+
+    return oss.str();
+}
+
+// Lists several routes one after another, e.g. the Pareto trade-offs
+string formatPathOptions(const vector<PathDetails>& paths, const Graph& graph) {
+    if (paths.empty()) {
+        return formatPathDetails(PathDetails(), graph);
+    }
+    string all_options;
+    for (size_t i = 0; i < paths.size(); i++) {
+        all_options += "Option " + to_string(i + 1) + " of " + to_string(paths.size()) + ":\n" + formatPathDetails(paths[i], graph);
+    }
+    return all_options;
+}
+
+// Nested reachability bands around the university
+string formatIsochrone(const IsochroneResult& isochrone, const Graph& graph) {
+    ostringstream oss;
+
+    oss << "--- Reachable Stops ---" << endl;
+    int shown = 0;
+    for (size_t band = 0; band < isochrone.thresholds.size(); band++) {
+        oss << "Within " << isochrone.thresholds[band] << ": " << isochrone.counts[band] << " stops" << endl;
+        for (; shown < isochrone.counts[band]; shown++) {
+            oss << "  " << graph.getNodeName(isochrone.node_ids[shown]) << " (" << isochrone.distances[shown] << ")" << endl;
+        }
+    }
+    oss << "-----------------------" << endl;
+
+    return oss.str();
+}
+
+// Timetable counterpart of formatPathDetails
+string formatJourneyDetails(const vector<Journey>& journeys, const Graph& graph) {
+    ostringstream oss;
+
+    oss << "--- Journey Details ---" << endl;
+    if (journeys.empty() || !journeys.front().journey_exists) {
+        oss << "No journey found." << endl;
+        return oss.str();
+    }
+
+    for (const Journey& journey : journeys) {
+        for (const JourneyLeg& leg : journey.legs) {
+            oss << (leg.route_id == -1 ? string("Walk") : timetable.route_names[leg.route_id]) << "  "
+                << formatClockTime(leg.board_time) << " " << graph.getNodeName(leg.board_stop_id) << " -> "
+                << formatClockTime(leg.alight_time) << " " << graph.getNodeName(leg.alight_stop_id) << endl;
+        }
+        oss << "Leave at: " << formatClockTime(journey.departure_time)
+            << ", arrive at: " << formatClockTime(journey.arrival_time)
+            << " (" << journey.num_transfers << " transfers)" << endl;
+        oss << "-----------------------" << endl;
+    }
+
+    return oss.str();
+}
+
+// Answer text plus the routes to highlight on the map
+QueryResult pathResult(const PathDetails& path, const Graph& graph) {
+    QueryResult result(formatPathDetails(path, graph));
+    if (path.path_exists) result.routes.push_back(path.node_ids_in_path);
+    result.stats = path.stats;
+    return result;
+}
+
+QueryResult pathOptionsResult(const vector<PathDetails>& paths, const Graph& graph, const SearchStats& stats) {
+    QueryResult result(formatPathOptions(paths, graph));
+    result.stats = stats;
+    for (const PathDetails& path : paths) {
+        if (path.path_exists) result.routes.push_back(path.node_ids_in_path);
+    }
+    return result;
+}
+
+QueryResult journeyResult(const vector<Journey>& journeys, const Graph& graph, const SearchStats& stats) {
+    QueryResult result(formatJourneyDetails(journeys, graph));
+    result.stats = stats;
+    for (const Journey& journey : journeys) {
+        if (journey.journey_exists) result.routes.push_back(journey.node_ids_in_path);
+    }
+    return result;
+}
+
+// Queue a search on the background thread. The query gets the snapshot current when it starts
+// and returns the text for "Route Details"; it replaces any query that is still waiting.
+void submitRouteQuery(const string& name, function<QueryResult(const Graph&)> query) {
+    LatencyHistogram* latency = &queryLatency(name);
+    route_result = query_runner->submitQuery([query, latency]() {
+        GraphStore::ReadGuard snapshot = network_store->read();
+        auto started = chrono::steady_clock::now();
+        QueryResult result = query(*snapshot);
+        latency->record(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - started).count());
+        return result;
+    });
+    route_job_name = name;
+    route_job_started = ImGui::GetTime();
+}
+
+// " Did you mean: a, b?" for a name that was not found, or "" if nothing is close
+string suggestStops(const Graph& graph, const vector<FuzzyMatch>& matches) {
+    if (matches.empty()) return "";
+    string text = " Did you mean:";
+    for (size_t i = 0; i < matches.size(); i++) {
+        text += (i == 0 ? " " : ", ") + string(graph.getNodeName(matches[i].node_id));
+    }
+    return text + "?";
+}
+
+// Most queries start by resolving the typed name, which may need the spelling fallback, so that
+// runs in the job too. A clearly closest spelling is used in place of a name that is not found.
+void submitFromStartQuery(const string& name, function<QueryResult(const Graph&, int)> query) {
+    string start_stop_name(start_location_input);
+    submitRouteQuery(name, [start_stop_name, query](const Graph& graph) -> QueryResult {
+        int start_node_id = graph.getNodeIndexByname(start_stop_name);
+        string note;
+        if (start_node_id == -1) {
+            vector<FuzzyMatch> matches = stop_matcher.search(graph, start_stop_name);
+            if (!FuzzyNameMatcher::clearlyBest(matches)) {
+                return "Error: Starting location '" + start_stop_name + "' not found in the map." + suggestStops(graph, matches);
+            }
+            start_node_id = matches[0].node_id;
+            note = "'" + start_stop_name + "' not found; showing the closest match '" + string(graph.getNodeName(start_node_id)) + "'.\n";
+        }
+        QueryResult result = query(graph, start_node_id);
+        result.text = note + result.text;
+        return result;
+    });
+}
+
+// Collapsible latency table: per algorithm, then frames, with the current graph's memory
+void drawPerformancePanel() {
+    if (!ImGui::CollapsingHeader("Performance")) return;
+
+    double now = ImGui::GetTime();
+    if (now - rate_sampled_at >= 1.0) {
+        for (QueryLatency& entry : query_latencies) {
+            uint64_t count = entry.histogram.count();
+            entry.per_second = (count - entry.count_at_sample) / (now - rate_sampled_at);
+            entry.count_at_sample = count;
+        }
+        rate_sampled_at = now;
+    }
+
+    if (ImGui::BeginTable("##Latency", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+        const char* headers[] = {"Algorithm", "Queries", "p50 ms", "p99 ms", "Max ms", "Queries/s"};
+        for (const char* header : headers) ImGui::TableSetupColumn(header);
+        ImGui::TableHeadersRow();
+        for (const QueryLatency& entry : query_latencies) {
+            LatencySummary latency = entry.histogram.summary();
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(entry.name.c_str());
+            ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(latency.count));
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", latency.p50_ms);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", latency.p99_ms);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", latency.max_ms);
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", entry.per_second);
+        }
+        ImGui::EndTable();
+    }
+    if (query_latencies.empty()) ImGui::TextDisabled("No queries run yet.");
+
+    LatencySummary frames = frame_times.summary();
+    ImGui::Text("Frame time: %.2f ms p50, %.2f ms p99, %.2f ms max (%.0f FPS)", frames.p50_ms, frames.p99_ms,
+                frames.max_ms, ImGui::GetIO().Framerate);
+    size_t graph_bytes = network_store->read()->sizeInBytes();
+    ImGui::Text("Graph memory: %.2f MB", graph_bytes / (1024.0 * 1024.0));
+    if (ImGui::SmallButton("Reset frame times")) frame_times.clear();
+}
+
+// Prefix lookups are a binary search per index run, cheap enough to run on the render thread
+void refreshStartSuggestions() {
+    start_suggestions.clear();
+    string typed(start_location_input);
+    if (typed.empty()) return;
+    GraphStore::ReadGuard graph = network_store->read();
+    for (int id : graph->findNodesByPrefix(typed, MAX_START_SUGGESTIONS)) {
+        start_suggestions.push_back(string(graph->getNodeName(id)));
+    }
+    if (start_suggestions.size() == 1 && start_suggestions.front() == typed) {
+        start_suggestions.clear(); // Already complete
+    }
+}
+
+// Dropdown under the start location box while it is being edited; picking a name fills it in
+void drawStartSuggestions(bool input_active) {
+    if (start_suggestions.empty() || (!input_active && !start_suggestions_hovered)) {
+        start_suggestions_hovered = false;
+        return;
+    }
+    float height = ImGui::GetTextLineHeightWithSpacing() * start_suggestions.size() + ImGui::GetStyle().FramePadding.y * 2.0f;
+    if (ImGui::BeginListBox("##StartSuggestions", ImVec2(ImGui::CalcItemWidth(), height))) {
+        start_suggestions_hovered = ImGui::IsWindowHovered();
+        for (const string& name : start_suggestions) {
+            if (ImGui::Selectable(name.c_str())) {
+                snprintf(start_location_input, IM_ARRAYSIZE(start_location_input), "%s", name.c_str());
+                start_suggestions.clear();
+                start_suggestions_hovered = false;
+                break;
+            }
+        }
+        ImGui::EndListBox();
+    }
+}
+
+// Rotating arc drawn inline while a query is running
+void drawSpinner(float radius, float thickness) {
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    ImVec2 pos = ImGui::GetCursorScreenPos();
+    ImVec2 centre(pos.x + radius, pos.y + ImGui::GetTextLineHeight() * 0.5f);
+    float start = (float)ImGui::GetTime() * 6.0f;
+    draw_list->PathArcTo(centre, radius, start, start + 4.5f, 24);
+    draw_list->PathStroke(ImGui::GetColorU32(ImGuiCol_ButtonHovered), 0, thickness);
+    ImGui::Dummy(ImVec2(radius * 2.0f, ImGui::GetTextLineHeight()));
+}
+
+// Function to append a new node to the nodes file; false if the file cannot be opened
+bool appendNodeToFile(int node_id, string_view node_name, const string& filename) {
+    TraceSpan span("append node to file", "edit");
+    ofstream outFile(filename, ios::app);
+    if (!outFile.is_open()) {
+        return false;
+    }
+    outFile << endl << node_id << " " << node_name; // Output to file with endl
+    outFile.close();
+    return true;
+}
+
+// Function to append a new edge to the edges file; false if the file cannot be opened
+bool appendEdgeToFile(int source_id, int dest_id, double weight, const string& filename) {
+    TraceSpan span("append edge to file", "edit");
+    ofstream outFile(filename, ios::app);
+    if (!outFile.is_open()) {
+        return false;
+    }
+    outFile << endl << source_id << " " << dest_id << " " << fixed << setprecision(1) << weight; // Output to file with endl
+    outFile.close();
+    return true;
+}
+
+// Global char buffers for add data inputs
+char new_location_name_input[256] = "";
+char source_name_input[256] = "";
+char dest_name_input[256] = "";
+float new_weight_input = 0.0f;
+
+// Edits are checked, applied and saved on the background thread. It is the only writer, so the
+// snapshot it validates against is exactly the version its edit is applied to.
+void handleAddDataGUI(GraphStore* store, const string& nodes_filename, const string& edges_filename) {
+    // This function will be called within an ImGui::Begin/End block
+    ImGui::Text("Add New Location or Route:");
+    ImGui::Separator();
+
+    // Add New Location (Node)
+    ImGui::Text("Add New Location:");
+    ImGui::InputText("##NewLocationName", new_location_name_input, IM_ARRAYSIZE(new_location_name_input));
+    ImGui::SameLine();
+    if (ImGui::Button("Add Location")) {
+        string new_location_name_str(new_location_name_input);
+        if (new_location_name_str.empty()) {
+            add_data_status_text = "Error: Location name cannot be empty.";
+        } else {
+            edit_results.push_back(query_runner->submitEdit([store, new_location_name_str, nodes_filename]() -> string {
+                int new_node_id;
+                {
+                    GraphStore::ReadGuard graph = store->read();
+                    if (graph->getNodeIndexByname(new_location_name_str) != -1) {
+                        return "Error: Location '" + new_location_name_str + "' already exists.";
+                    }
+                    new_node_id = graph->getNumNodes();
+                }
+                store->queueEdit([new_node_id, new_location_name_str](Graph& graph) {
+                    graph.addNode(new_node_id, new_location_name_str);
+                });
+                store->publish();
+                // Persist
+                GraphStore::ReadGuard graph = store->read();
+                if (Map::detectFormat(nodes_filename) == MAP_FORMAT_SINGLE_FILE) {
+                    if (!Map::save_single_file(*graph, nodes_filename)) {
+                        return "Error: Added location '" + new_location_name_str + "' but could not save map file: '" + nodes_filename + "'";
+                    }
+                } else if (!appendNodeToFile(new_node_id, graph->getNodeName(new_node_id), nodes_filename)) {
+                    return "Error: Could not open nodes file for appending: '" + nodes_filename + "'";
+                }
+                return "Successfully added new location: " + new_location_name_str + " (ID: " + to_string(new_node_id) + ")";
+            }));
+            add_data_status_text = "Adding location...";
+            new_location_name_input[0] = '\0'; // Clear input field
+        }
+    }
+
+    ImGui::Spacing();
+    ImGui::Separator();
+
+    // Add New Route (Edge)
+    ImGui::Text("Add New Route:");
+    ImGui::InputText("Source Name", source_name_input, IM_ARRAYSIZE(source_name_input));
+    ImGui::InputText("Destination Name", dest_name_input, IM_ARRAYSIZE(dest_name_input));
+    ImGui::InputFloat("Weight", &new_weight_input, 0.1f, 1.0f, "%.1f"); // For float input
+
+    if (ImGui::Button("Add Route")) {
+        string source_name_str(source_name_input);
+        string dest_name_str(dest_name_input);
+        double weight = new_weight_input;
+
+        if (weight < 0) {
+            add_data_status_text = "Error: Weight cannot be negative.";
+        } else {
+            edit_results.push_back(query_runner->submitEdit([store, source_name_str, dest_name_str, weight, nodes_filename, edges_filename]() -> string {
+                int source_id, dest_id;
+                {
+                    GraphStore::ReadGuard graph = store->read();
+                    source_id = graph->getNodeIndexByname(source_name_str);
+                    dest_id = graph->getNodeIndexByname(dest_name_str);
+                }
+                if (source_id == -1) {
+                    GraphStore::ReadGuard graph = store->read();
+                    return "Error: Source location '" + source_name_str + "' not found." + suggestStops(*graph, stop_matcher.search(*graph, source_name_str));
+                } else if (dest_id == -1) {
+                    GraphStore::ReadGuard graph = store->read();
+                    return "Error: Destination location '" + dest_name_str + "' not found." + suggestStops(*graph, stop_matcher.search(*graph, dest_name_str));
+                } else if (source_id == dest_id) {
+                    return "Error: Cannot add route to itself.";
+                }
+                store->queueEdit([source_id, dest_id, weight](Graph& graph) {
+                    graph.addEdge(source_id, dest_id, weight);
+                });
+                store->publish();
+                // Persist
+                if (Map::detectFormat(nodes_filename) == MAP_FORMAT_SINGLE_FILE) {
+                    GraphStore::ReadGuard graph = store->read();
+                    if (!Map::save_single_file(*graph, nodes_filename)) {
+                        return "Error: Added route but could not save map file: '" + nodes_filename + "'";
+                    }
+                } else if (!appendEdgeToFile(source_id, dest_id, weight, edges_filename)) {
+                    return "Error: Could not open edges file for appending: '" + edges_filename + "'";
+                }
+                return "Successfully added route between " + source_name_str + " and " + dest_name_str + " with weight " + to_string(weight);
+            }));
+            add_data_status_text = "Adding route...";
+            source_name_input[0] = '\0'; // Clear input fields
+            dest_name_input[0] = '\0';
+            new_weight_input = 0.0f;
+        }
+    }
+
+    // Edits finish in order; show each status as it arrives
+    while (!edit_results.empty() && isReady(edit_results.front())) {
+        add_data_status_text = edit_results.front().get().text;
+        edit_results.pop_front();
+    }
+    ImGui::TextWrapped("Status: %s", add_data_status_text.c_str());
+}
+
+
+// Function to handle GLFW errors
+void glfw_error_callback(int error, const char* description) {
+    fprintf(stderr, "GLFW Error %d: %s\n", error, description);
+}
+
+// Set COMMUTE_TRACE=trace.json to record load, query and edit spans (trace.h); the file is
+// written on exit and opens in chrome://tracing or ui.perfetto.dev. Set COMMUTE_QUERY_LOG=queries.bin
+// to log every search for commute_replay (query_log.h).
+int main() {
+    Tracer::startFromEnvironment();
+    query_log.openFromEnvironment();
+    Tracer::setThreadName("render");
+
+    // 1. Initialize GLFW
+    glfwSetErrorCallback(glfw_error_callback);
+    if (!glfwInit()) {
+        cerr << "Failed to initialize GLFW!" << endl;
+        return 1;
+    }
+
+    // 2. Configure OpenGL Context (for ImGui OpenGL3 backend)
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_MAXIMIZED, GLFW_TRUE);
+
+    // 3. Create a GLFW window
+    GLFWwindow* window = glfwCreateWindow(1280, 720, "Commute Optimizer GUI", NULL, NULL);
+    if (window == NULL) {
+        cerr << "Failed to create GLFW window!" << endl;
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(1);
+
+    // 4. Load OpenGL functions using GLAD
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        cerr << "Failed to initialize GLAD!" << endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    // 5. Setup ImGui context
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO(); (void)io;
+    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+    io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;
+    io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
+
+    // 6. Setup ImGui style (more customization options)
+    ImGui::StyleColorsDark();
+    ImGuiStyle& style = ImGui::GetStyle();
+    // Example: Make window background slightly transparent for a cooler look
+    style.Colors[ImGuiCol_WindowBg].w = 0.9f;
+    // Example: Change button colors
+    style.Colors[ImGuiCol_Button] = ImVec4(0.26f, 0.59f, 0.98f, 0.40f);
+    style.Colors[ImGuiCol_ButtonHovered] = ImVec4(0.26f, 0.59f, 0.98f, 1.00f);
+    style.Colors[ImGuiCol_ButtonActive] = ImVec4(0.06f, 0.53f, 0.98f, 1.00f);
+
+    // 7. Setup Platform/Renderer backends
+    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplOpenGL3_Init("#version 330");
+
+
+    // --- File loading UI and logic ---
+    bool map_loaded = false;
+    char nodes_filename_buffer[256] = "nodes.txt";
+    char edges_filename_buffer[256] = "edges.txt";
+    char timetable_filename_buffer[256] = "";
+
+    while (!map_loaded && !glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplGlfw_NewFrame();
+        ImGui::NewFrame();
+
+        ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x * 0.5f, ImGui::GetIO().DisplaySize.y * 0.5f), ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
+        ImGui::Begin("Load Map Files", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoMove);
+        ImGui::Text("Please enter map filenames:");
+        ImGui::InputText("Nodes File", nodes_filename_buffer, IM_ARRAYSIZE(nodes_filename_buffer));
+        ImGui::SetItemTooltip("A nodes file, or a single-file map such as Summer_Routes.txt.");
+        ImGui::InputText("Edges File", edges_filename_buffer, IM_ARRAYSIZE(edges_filename_buffer));
+        ImGui::SetItemTooltip("Ignored when the nodes file is a single-file map.");
+        ImGui::InputText("Timetable File (optional)", timetable_filename_buffer, IM_ARRAYSIZE(timetable_filename_buffer));
+
+        if (ImGui::Button("Load Map")) {
+            if (map_instance) delete map_instance;
+            map_instance = new Map(nodes_filename_buffer, edges_filename_buffer);
+
+            Graph bus_network;
+            if (map_instance->map_to_graph(bus_network)) {
+                map_loaded = true;
+                cout << "Map loaded successfully for GUI." << endl;
+                if (timetable_filename_buffer[0] != '\0') {
+                    if (timetable.load(timetable_filename_buffer, bus_network)) {
+                        csa_engine = new ConnectionScanEngine(timetable);
+                    } else {
+                        cerr << "Failed to load timetable. Continuing with static weights." << endl;
+                    }
+                }
+                network_store = new GraphStore(move(bus_network));
+                query_runner = new QueryRunner();
+            } else {
+                cerr << "Failed to load map. Check filenames." << endl;
+                delete map_instance;
+                map_instance = nullptr;
+            }
+        }
+        ImGui::End();
+
+        ImGui::Render();
+        int display_w, display_h;
+        glfwGetFramebufferSize(window, &display_w, &display_h);
+        glViewport(0, 0, display_w, display_h);
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        glfwSwapBuffers(window);
+    }
+
+    if (!map_loaded) {
+        if (map_instance) {
+            delete map_instance;
+            map_instance = nullptr;
+        }
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui_ImplGlfw_Shutdown();
+        ImGui::DestroyContext();
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+
+    // Main GUI loop
+    ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
+    const int UNIVERSITY_NODE_ID = 0;
+
+    while (!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+        frame_times.record(static_cast<uint64_t>(ImGui::GetIO().DeltaTime * 1e6));
+
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplGlfw_NewFrame();
+        ImGui::NewFrame();
+
+        // 8. Main Commute Optimizer UI
+        ImGui::Begin("University Commute Optimizer", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+
+        // --- Header Section with Colors/Shapes ---
+        ImGui::TextColored(ImVec4(0.8f, 0.2f, 0.2f, 1.0f), "Welcome to Your Commute Optimizer!");
+        ImGui::SameLine(0.0f, ImGui::GetContentRegionAvail().x - 120);
+        ImGui::TextDisabled("v1.0.0");
+
+        ImGui::Dummy(ImVec2(0.0f, 5.0f));
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        ImVec2 p = ImGui::GetCursorScreenPos();
+        draw_list->AddRectFilled(p, ImVec2(p.x + ImGui::GetContentRegionAvail().x, p.y + 3.0f), ImU32(IM_COL32(0, 100, 150, 255)));
+        ImGui::Dummy(ImVec2(0.0f, 5.0f));
+
+        ImGui::Text("Destination: %s (ID: %d)", map_instance->getUniversityName().c_str(), UNIVERSITY_NODE_ID);
+        ImGui::Separator();
+
+        // --- Route Finding Section ---
+        ImGui::Text("Find Your Route:");
+        if (ImGui::InputText("##StartLoc", start_location_input, IM_ARRAYSIZE(start_location_input))) {
+            refreshStartSuggestions();
+        }
+        bool start_input_active = ImGui::IsItemActive();
+        ImGui::SetItemTooltip("Enter your starting location name here.");
+        drawStartSuggestions(start_input_active);
+        if (csa_engine) {
+            ImGui::SetNextItemWidth(80);
+            ImGui::InputText("Departure (HH:MM)", departure_time_input, IM_ARRAYSIZE(departure_time_input));
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(80);
+            ImGui::InputText("Window End (HH:MM)", window_end_input, IM_ARRAYSIZE(window_end_input));
+        }
+
+        ImGui::Spacing();
+
+        ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.2f, 0.6f, 0.2f, 1.0f));
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.3f, 0.7f, 0.3f, 1.0f));
+        ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.1f, 0.5f, 0.1f, 1.0f));
+        if (ImGui::Button(csa_engine ? "Find Fastest Route (Timetable)" : "Find Fastest Route (Dijkstra)", ImVec2(200, 30))) {
+            if (csa_engine) {
+                int departure_time = parseClockTime(departure_time_input);
+                if (departure_time < 0) {
+                    path_display_text = "Error: Departure time must look like 07:30.";
+                } else {
+                    submitFromStartQuery("Timetable", [departure_time](const Graph& graph, int start_node_id) -> QueryResult {
+                        if (start_node_id >= timetable.numStops) {
+                            return "Error: '" + string(graph.getNodeName(start_node_id)) + "' was added after the timetable was loaded.";
+                        }
+                        query_log.record(QUERY_CSA, start_node_id, UNIVERSITY_NODE_ID, departure_time);
+                        Journey journey = csa_engine->earliestArrival<PanelSearchStats>(start_node_id, UNIVERSITY_NODE_ID, departure_time);
+                        return journeyResult({journey}, graph, journey.stats);
+                    });
+                }
+            } else {
+                submitFromStartQuery("Dijkstra", [](const Graph& graph, int start_node_id) -> QueryResult {
+                    query_log.record(QUERY_DIJKSTRA, start_node_id, UNIVERSITY_NODE_ID);
+                    return pathResult(graph.Dijkstra<PanelSearchStats>(start_node_id, UNIVERSITY_NODE_ID), graph);
+                });
+            }
+        }
+        ImGui::PopStyleColor(3);
+
+        ImGui::SameLine(0.0f, 10.0f);
+
+        ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.8f, 0.4f, 0.1f, 1.0f));
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.9f, 0.5f, 0.2f, 1.0f));
+        ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.7f, 0.3f, 0.0f, 1.0f));
+        if (ImGui::Button("Find Minimum Stops (BFS)", ImVec2(200, 30))) {
+            submitFromStartQuery("BFS", [](const Graph& graph, int start_node_id) -> QueryResult {
+                query_log.record(QUERY_BFS, start_node_id, UNIVERSITY_NODE_ID);
+                return pathResult(graph.BFS<PanelSearchStats>(start_node_id, UNIVERSITY_NODE_ID), graph);
+            });
+        }
+        ImGui::PopStyleColor(3);
+
+        ImGui::SameLine(0.0f, 10.0f);
+        if (ImGui::Button("Time vs Stops (Pareto)", ImVec2(200, 30))) {
+            submitFromStartQuery("Pareto", [](const Graph& graph, int start_node_id) -> QueryResult {
+                query_log.record(QUERY_PARETO, start_node_id, UNIVERSITY_NODE_ID);
+                ParetoSearch pareto(graph);
+                vector<PathDetails> options = pareto.search<PanelSearchStats>(start_node_id, UNIVERSITY_NODE_ID);
+                return pathOptionsResult(options, graph, pareto.lastStats());
+            });
+        }
+
+        if (ImGui::Button("Backup Routes", ImVec2(200, 30))) {
+            int k = backup_route_count;
+            submitFromStartQuery("Backup routes", [k](const Graph& graph, int start_node_id) -> QueryResult {
+                query_log.record(QUERY_KSP, start_node_id, UNIVERSITY_NODE_ID, k);
+                KShortestPaths ksp(graph);
+                vector<PathDetails> routes = ksp.search<PanelSearchStats>(start_node_id, UNIVERSITY_NODE_ID, k);
+                return pathOptionsResult(routes, graph, ksp.lastStats());
+            });
+        }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(100);
+        ImGui::InputInt("Routes", &backup_route_count);
+        if (backup_route_count < 1) backup_route_count = 1;
+
+        if (ImGui::Button("Alternative Routes", ImVec2(200, 30))) {
+            AlternativeMethod method = (AlternativeMethod)alternative_method;
+            submitFromStartQuery("Alternatives", [method](const Graph& graph, int start_node_id) -> QueryResult {
+                query_log.record(QUERY_ALTERNATIVES, start_node_id, UNIVERSITY_NODE_ID, method);
+                AlternativeRoutes alternatives(graph);
+                vector<PathDetails> routes = alternatives.search<PanelSearchStats>(start_node_id, UNIVERSITY_NODE_ID, method);
+                return pathOptionsResult(routes, graph, alternatives.lastStats());
+            });
+        }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(100);
+        ImGui::Combo("Method", &alternative_method, "Plateaus\0Penalties\0");
+
+        if (ImGui::Button("Reachable Stops", ImVec2(200, 30))) {
+            istringstream limits(isochrone_limits_input);
+            vector<double> thresholds;
+            double limit;
+            while (limits >> limit) {
+                if (limit >= 0) thresholds.push_back(limit);
+            }
+            if (thresholds.empty()) {
+                path_display_text = "Error: Enter one or more time limits, e.g. 30 45 60.";
+            } else {
+                submitRouteQuery("Reachable stops", [thresholds](const Graph& graph) -> QueryResult {
+                    query_log.recordIsochrone(UNIVERSITY_NODE_ID, thresholds);
+                    IsochroneSearch isochrone(graph);
+                    IsochroneResult reachable = isochrone.search<PanelSearchStats>(UNIVERSITY_NODE_ID, thresholds);
+                    QueryResult result(formatIsochrone(reachable, graph));
+                    result.stats = reachable.stats;
+                    return result;
+                });
+            }
+        }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(100);
+        ImGui::InputText("Time Limits", isochrone_limits_input, IM_ARRAYSIZE(isochrone_limits_input));
+        ImGui::SetItemTooltip("Travel times from the university, separated by spaces.");
+
+        if (csa_engine) {
+            ImGui::SameLine(0.0f, 10.0f);
+            if (ImGui::Button("All Departures in Window", ImVec2(200, 30))) {
+                int window_start = parseClockTime(departure_time_input);
+                int window_end = parseClockTime(window_end_input);
+                if (window_start < 0 || window_end < window_start) {
+                    path_display_text = "Error: Enter a departure window such as 07:00 to 09:00.";
+                } else {
+                    submitFromStartQuery("Departures", [window_start, window_end](const Graph& graph, int start_node_id) -> QueryResult {
+                        if (start_node_id >= timetable.numStops) {
+                            return "Error: '" + string(graph.getNodeName(start_node_id)) + "' was added after the timetable was loaded.";
+                        }
+                        query_log.record(QUERY_CSA_PROFILE, start_node_id, UNIVERSITY_NODE_ID, window_start, window_end);
+                        vector<Journey> journeys = csa_engine->profile<PanelSearchStats>(start_node_id, UNIVERSITY_NODE_ID, window_start, window_end);
+                        return journeyResult(journeys, graph, csa_engine->lastStats());
+                    });
+                }
+            }
+        }
+
+        ImGui::Separator();
+        ImGui::Text("Route Details:");
+        if (isReady(route_result)) {
+            QueryResult answer = route_result.get();
+            path_display_text = answer.text;
+            route_stats = answer.stats;
+            map_routes = answer.routes;
+            map_routes_version++;
+        }
+        if (route_result.valid()) {
+            // Still running: the previous answer stays visible underneath
+            drawSpinner(7.0f, 3.0f);
+            ImGui::SameLine();
+            ImGui::Text("Computing %s... %.1f s", route_job_name.c_str(), ImGui::GetTime() - route_job_started);
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Cancel")) {
+                query_runner->cancelQueries();
+                route_result = future<QueryResult>(); // A search already running stops at its next check
+            }
+        }
+        ImGui::TextWrapped("%s", path_display_text.c_str());
+        if (route_stats.collected && ImGui::TreeNode("Search statistics")) {
+            ImGui::Text("Nodes settled: %lld   Edges relaxed: %lld", route_stats.nodes_settled, route_stats.edges_relaxed);
+            ImGui::Text("Queue pushes: %lld   Pops: %lld (%lld stale)   Peak size: %zu", route_stats.heap_pushes,
+                        route_stats.heap_pops, route_stats.stale_pops, route_stats.peak_queue);
+            ImGui::Text("Time: %.3f ms wall, %.3f ms CPU", route_stats.wall_ms, route_stats.cpu_ms);
+            if (route_stats.hardware.measured) {
+                ImGui::Text("Hardware: %s", route_stats.hardware.summary().c_str());
+            } else {
+                ImGui::TextDisabled("Hardware counters: %s", PerfCounters::forThisThread().unavailableReason().c_str());
+            }
+            ImGui::TreePop();
+        }
+
+        ImGui::Spacing();
+        ImGui::Separator();
+
+        drawPerformancePanel();
+
+        ImGui::Spacing();
+        ImGui::Separator();
+
+        // --- Add New Data Section ---
+        handleAddDataGUI(network_store, nodes_filename_buffer, edges_filename_buffer);
+
+        ImGui::Spacing();
+        ImGui::Separator();
+
+        // --- Exit Button ---
+        ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.7f, 0.1f, 0.1f, 1.0f));
+        ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.8f, 0.2f, 0.2f, 1.0f));
+        ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4(0.6f, 0.0f, 0.0f, 1.0f));
+        if (ImGui::Button("Exit", ImVec2(ImGui::GetContentRegionAvail().x, 30))) {
+            glfwSetWindowShouldClose(window, true);
+        }
+        ImGui::PopStyleColor(3);
+
+        ImGui::End(); // End Main Commute Optimizer window
+
+        // --- Network Map Window ---
+        ImGui::SetNextWindowSize(ImVec2(700, 600), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Network Map");
+        {
+            if (isReady(map_layout_result)) {
+                QueryResult laid_out = map_layout_result.get();
+                if (laid_out.map_layout) map_layout_requested = laid_out.map_layout->graph_version;
+                network_map.setLayout(laid_out.map_layout);
+            }
+            // One layout job at a time; edits made meanwhile get theirs when it is done
+            if (!map_layout_result.valid() && network_store->version() != map_layout_requested) {
+                map_layout_requested = network_store->version();
+                map_layout_result = query_runner->submitBackground([]() {
+                    GraphStore::ReadGuard snapshot = network_store->read();
+                    QueryResult result;
+                    result.map_layout = make_shared<const MapLayout>(*snapshot, snapshot.version());
+                    return result;
+                });
+            }
+            GraphStore::ReadGuard graph = network_store->read();
+            network_map.draw(*graph, map_routes, map_routes_version);
+        }
+        ImGui::End();
+
+        // Rendering
+        ImGui::Render();
+        int display_w, display_h;
+        glfwGetFramebufferSize(window, &display_w, &display_h);
+        glViewport(0, 0, display_w, display_h);
+        glClearColor(clear_color.x * clear_color.w, clear_color.y * clear_color.w, clear_color.z * clear_color.w, clear_color.w);
+        glClear(GL_COLOR_BUFFER_BIT);
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+        glfwSwapBuffers(window);
+    }
+
+    // Cleanup; stop the background thread before the data it searches goes away
+    if (query_runner) {
+        delete query_runner;
+        query_runner = nullptr;
+    }
+    if (network_store) {
+        delete network_store;
+        network_store = nullptr;
+    }
+    if (map_instance) {
+        delete map_instance;
+        map_instance = nullptr;
+    }
+    if (csa_engine) {
+        delete csa_engine;
+        csa_engine = nullptr;
+    }
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    Tracer::finish();
+    return 0;
+}
@@ -0,0 +1,250 @@
+#ifndef ALTERNATIVES_H
+#define ALTERNATIVES_H
+
+#include <algorithm>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include "graphV1.h"
+#include "search_workspace.h"
+
+using namespace std;
+
+enum AlternativeMethod {
+    ALTERNATIVES_PLATEAU,   // Two shortest-path trees, one candidate per plateau
+    ALTERNATIVES_PENALTY    // Repeated searches with the weights of used roads increased
+};
+
+// Admissibility filters for an alternative route
+struct AlternativeOptions {
+    int max_alternatives = 3;   // Routes returned besides the fastest one
+    double max_sharing = 0.6;   // Largest fraction of the fastest route's weight a route may share with chosen ones
+    double max_stretch = 1.4;   // Longest allowed route, relative to the fastest
+    double penalty = 0.5;       // Penalty method: weight increase per previous use of a road
+    int max_iterations = 10;    // Penalty method: searches before giving up
+};
+
+// Meaningfully different routes to the same destination.
+// Both methods keep their search workspaces between calls, so after the first query no search
+// refills its distance arrays, and the plateau method needs just two bounded tree searches.
+class AlternativeRoutes {
+private:
+    const Graph& graph;
+    SearchWorkspace forward;
+    SearchWorkspace backward;
+    unordered_map<long long, int> road_uses;   // Penalty method: times each road was already chosen
+    double penalty_factor = 0.0;
+    SearchStats last_stats;
+
+    static const int MAX_PLATEAU_CANDIDATES = 256; // Via routes checked for admissibility per query
+
+    long long roadKey(int u, int v) const {
+        if (u > v) swap(u, v);
+        return static_cast<long long>(u) * graph.getNumNodes() + v;
+    }
+
+    double edgeWeight(int u, int v) const {
+        double best = DOUBLE_INF;
+        for (const Edge& edge : graph.getEdges(u)) {
+            if (edge.destination_node_id == v) best = min(best, edge.weight);
+        }
+        return best;
+    }
+
+    // One-to-all Dijkstra that stops settling beyond bound (penalised weights if penalise is set)
+    template <class Stats>
+    void growTree(SearchWorkspace& ws, int root, double bound, bool penalise, Stats& counters, int stop_at = -1) {
+        ws.prepare(graph.getNumNodes());
+        ws.update(root, 0.0, -1);
+        ws.push(0.0, root);
+        counters.pushed(ws.heap.size());
+        while (!ws.heap.empty()) {
+            SearchWorkspace::HeapEntry top = ws.pop();
+            counters.popped();
+            int u = top.second;
+            if (ws.isSettled(u)) {
+                counters.stale();
+                continue;
+            }
+            if (top.first > bound) break;
+            ws.settle(u);
+            counters.settled();
+            if (u == stop_at) break;
+            for (const Edge& edge : graph.getEdges(u)) {
+                counters.relaxed();
+                double weight = edge.weight;
+                if (penalise) {
+                    auto uses = road_uses.find(roadKey(u, edge.destination_node_id));
+                    if (uses != road_uses.end()) weight *= 1.0 + penalty_factor * uses->second;
+                }
+                double d = top.first + weight;
+                if (d < ws.distance(edge.destination_node_id)) {
+                    ws.update(edge.destination_node_id, d, u);
+                    ws.push(d, edge.destination_node_id);
+                    counters.pushed(ws.heap.size());
+                }
+            }
+        }
+    }
+
+    PathDetails makePath(const vector<int>& nodes) const {
+        PathDetails result;
+        result.path_exists = true;
+        result.node_ids_in_path = nodes;
+        result.num_stops = static_cast<int>(nodes.size()) - 1;
+        result.total_weight = 0.0;
+        for (size_t i = 1; i < nodes.size(); i++) result.total_weight += edgeWeight(nodes[i - 1], nodes[i]);
+        return result;
+    }
+
+    // Limited sharing with every route picked so far, bounded stretch and no repeated stop
+    bool admissible(const PathDetails& candidate, const vector<PathDetails>& chosen, const AlternativeOptions& options) const {
+        double best = chosen.front().total_weight;
+        if (candidate.total_weight > options.max_stretch * best) return false;
+
+        unordered_set<int> stops(candidate.node_ids_in_path.begin(), candidate.node_ids_in_path.end());
+        if (stops.size() != candidate.node_ids_in_path.size()) return false;
+
+        for (const PathDetails& route : chosen) {
+            unordered_set<long long> roads;
+            for (size_t i = 1; i < route.node_ids_in_path.size(); i++) {
+                roads.insert(roadKey(route.node_ids_in_path[i - 1], route.node_ids_in_path[i]));
+            }
+            if (route.node_ids_in_path == candidate.node_ids_in_path) return false;
+            double shared = 0.0;
+            for (size_t i = 1; i < candidate.node_ids_in_path.size(); i++) {
+                int u = candidate.node_ids_in_path[i - 1], v = candidate.node_ids_in_path[i];
+                if (roads.count(roadKey(u, v))) shared += edgeWeight(u, v);
+            }
+            if (shared > options.max_sharing * best) return false;
+        }
+        return true;
+    }
+
+    template <class Stats>
+    void plateauAlternatives(int s, int t, const AlternativeOptions& options, vector<PathDetails>& chosen, Stats& counters) {
+        double best = chosen.front().total_weight;
+        double bound = options.max_stretch * best;
+        growTree(forward, s, bound, false, counters);
+        growTree(backward, t, bound, false, counters);
+
+        // A plateau is a chain of roads that lies on both trees (possibly a single stop where the
+        // trees merely meet). Each plateau yields one via route: forward tree up to its first stop,
+        // the plateau, then the backward tree to t.
+        struct Plateau {
+            int first;
+            int last;
+            double length;
+            double cost;    // Weight of the via route
+        };
+        vector<Plateau> plateaus;
+        int numNodes = graph.getNumNodes();
+        auto onPlateau = [&](int u, int v) { // Road u -> v is in both trees
+            return forward.isSettled(v) && forward.previous(v) == u && backward.isSettled(u) && backward.previous(u) == v;
+        };
+        for (int u = 0; u < numNodes; u++) {
+            if (!forward.isSettled(u) || !backward.isSettled(u)) continue;
+            if (forward.distance(u) + backward.distance(u) > bound) continue;
+            int prev = forward.previous(u);
+            if (prev != -1 && onPlateau(prev, u)) continue; // Not the start of the chain
+
+            Plateau plateau{u, u, 0.0, 0.0};
+            while (backward.previous(plateau.last) != -1 && onPlateau(plateau.last, backward.previous(plateau.last))) {
+                plateau.last = backward.previous(plateau.last);
+            }
+            plateau.length = forward.distance(plateau.last) - forward.distance(plateau.first);
+            if (plateau.first == s || plateau.last == t) continue; // Part of the fastest route itself
+            plateau.cost = forward.distance(u) + backward.distance(u);
+            plateaus.push_back(plateau);
+        }
+
+        // Long plateaus give locally optimal routes; try them first, cheaper ones breaking ties
+        sort(plateaus.begin(), plateaus.end(), [](const Plateau& a, const Plateau& b) {
+            return a.length != b.length ? a.length > b.length : a.cost < b.cost;
+        });
+
+        vector<int> nodes;
+        int examined = 0;
+        for (const Plateau& plateau : plateaus) {
+            if (static_cast<int>(chosen.size()) > options.max_alternatives || examined++ >= MAX_PLATEAU_CANDIDATES) break;
+            nodes.clear();
+            for (int v = plateau.last; v != -1; v = forward.previous(v)) nodes.push_back(v);
+            reverse(nodes.begin(), nodes.end());
+            for (int v = backward.previous(plateau.last); v != -1; v = backward.previous(v)) nodes.push_back(v);
+            PathDetails candidate = makePath(nodes);
+            if (admissible(candidate, chosen, options)) chosen.push_back(candidate);
+        }
+    }
+
+    template <class Stats>
+    void penaltyAlternatives(int s, int t, const AlternativeOptions& options, vector<PathDetails>& chosen, Stats& counters) {
+        road_uses.clear();
+        penalty_factor = options.penalty;
+        vector<int> nodes;
+        for (int iteration = 0; iteration < options.max_iterations &&
+                                static_cast<int>(chosen.size()) <= options.max_alternatives; iteration++) {
+            // Penalise the roads of the most recently found route, chosen or not
+            const vector<int>& last = iteration == 0 ? chosen.front().node_ids_in_path : nodes;
+            for (size_t i = 1; i < last.size(); i++) road_uses[roadKey(last[i - 1], last[i])]++;
+
+            growTree(forward, s, DOUBLE_INF, true, counters, t);
+            if (!forward.isSettled(t)) break;
+            nodes.clear();
+            for (int v = t; v != -1; v = forward.previous(v)) nodes.push_back(v);
+            reverse(nodes.begin(), nodes.end());
+
+            PathDetails candidate = makePath(nodes);
+            if (admissible(candidate, chosen, options)) chosen.push_back(candidate);
+        }
+    }
+
+public:
+    AlternativeRoutes(const Graph& g) : graph(g) {}
+
+    // The fastest route followed by up to options.max_alternatives admissible alternatives
+    template <class Stats = NoSearchStats>
+    vector<PathDetails> search(int startNodeId, int endNodeId, AlternativeMethod method,
+                               const AlternativeOptions& options = AlternativeOptions()) {
+        TraceSpan span("Alternative routes", "search");
+        Stats counters;
+        last_stats = SearchStats();
+        vector<PathDetails> chosen;
+        int numNodes = graph.getNumNodes();
+        if (startNodeId >= numNodes || endNodeId >= numNodes || startNodeId < 0 || endNodeId < 0) {
+            cerr << "Error: Invalid start or end node ID in alternative routes." << endl;
+            return chosen;
+        }
+
+        growTree(forward, startNodeId, DOUBLE_INF, false, counters, endNodeId);
+        if (!forward.isSettled(endNodeId)) {
+            counters.finish(last_stats);
+            return chosen;
+        }
+        vector<int> nodes;
+        for (int v = endNodeId; v != -1; v = forward.previous(v)) nodes.push_back(v);
+        reverse(nodes.begin(), nodes.end());
+        PathDetails fastest = makePath(nodes);
+        fastest.total_weight = forward.distance(endNodeId);
+        chosen.push_back(fastest);
+        if (startNodeId == endNodeId) {
+            counters.finish(last_stats);
+            return chosen;
+        }
+
+        if (method == ALTERNATIVES_PLATEAU) {
+            plateauAlternatives(startNodeId, endNodeId, options, chosen, counters);
+        } else {
+            penaltyAlternatives(startNodeId, endNodeId, options, chosen, counters);
+        }
+        sort(chosen.begin() + 1, chosen.end(), [](const PathDetails& a, const PathDetails& b) {
+            return a.total_weight < b.total_weight;
+        });
+        counters.finish(last_stats);
+        return chosen;
+    }
+
+    // Instrumentation of the last search; collected only when it ran with CountSearchStats
+    const SearchStats& lastStats() const { return last_stats; }
+};
+
+#endif // ALTERNATIVES_H
@@ -0,0 +1,484 @@
+// Headless benchmarks for map loading, route searches and stop-name lookups, reported as JSON.
+//
+// Build: g++ -std=c++17 -O2 -pthread benchmark.cpp -o commute_bench
+// Run:   ./commute_bench                                  bundled maps plus generated networks
+//        ./commute_bench --sizes 1000,100000 --kinds grid,scale-free --queries 500 --seed 7 --out bench.json
+//        ./commute_bench --no-generated Summer_Routes.txt nodes.txt edges.txt
+//
+// Maps named on the command line replace the bundled ones; a split-format nodes file takes the
+// next argument as its edges file. Without any, nodes.txt + edges.txt and Summer_Routes.txt are
+// used when they are in the working directory. Generated networks (network_gen.h, one per size
+// and kind) are written in the split format to the temporary directory, so their load time goes
+// through Map::map_to_graph too.
+//
+// Per map the report has the load time (min and median of --repeat loads), Dijkstra and BFS
+// latency percentiles over --queries random start/end pairs, getNodeIndexByname throughput for
+// names that exist and names that do not, and the cost of createAdjacencyMatrix (skipped above
+// --matrix-limit stops, since the matrix is numNodes^2 doubles). All randomness comes from --seed.
+// Where perf_event_open works (perf_counters.h), the Dijkstra and BFS batches also report cycles,
+// instructions, cache and branch misses per query; elsewhere the report says why they are missing.
+//
+// The same queries then go through RouteSearch (route_search.h), which writes into a PathDetails
+// reused across queries. Every operator new in the process is counted, and after one warm-up pass
+// the timed pass must not allocate at all: the report gives the count, and the exit status is 1
+// if any map's count is not zero.
+//
+// Each map is also copied into the compact graph types, CompactGraph (uint32_t IDs and weights)
+// and CompactFloatGraph (uint32_t, float), to report their memory and RouteSearch Dijkstra
+// latency; their route totals must equal the (int, double) graph's, or the exit status is 1. A
+// map with fractional weights has no CompactGraph and reports null for it.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <new>
+#include <filesystem>
+#include <thread>
+#include "graphV1.h"
+#include "map.h"
+#include "network_gen.h"
+#include "perf_counters.h"
+#include "route_search.h"
+
+using namespace std;
+
+struct BenchOptions {
+    vector<int> sizes = {1000, 10000, 100000};
+    vector<NetworkKind> kinds = {NETWORK_GRID};
+    vector<string> kind_names = {"grid"};
+    int queries = 200;
+    int repeat = 3;
+    int matrix_limit = 2000;
+    unsigned seed = 1;
+    bool generated = true;
+    string out_filename;
+};
+
+// A map to measure: one single-file map or a nodes/edges pair
+struct BenchMap {
+    string name;
+    string source;              // "bundled", "command line" or "generated"
+    string nodes_filename;
+    string edges_filename;
+};
+
+struct LatencySummary {
+    double mean = 0, p50 = 0, p90 = 0, p99 = 0, max = 0;
+};
+
+// Keeps results alive so the optimiser cannot drop the work that produced them
+static volatile long long benchmark_sink = 0;
+
+// Every heap allocation made through operator new, counted by the replacements below
+static atomic<long long> heap_allocations(0);
+
+// Allocations RouteSearch made after warm-up, over all maps; should stay 0
+static long long reused_buffer_allocations = 0;
+
+// Queries where a compact graph's route total differed from the (int, double) graph's
+static long long compact_mismatches = 0;
+
+// Compile every member of the compact graph types, not just the ones used below
+template class BasicGraph<uint32_t, uint32_t>;
+template class BasicGraph<uint32_t, float>;
+
+// GCC cannot tell that these news and deletes belong together once they are inlined
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void* operator new(size_t size) {
+    heap_allocations.fetch_add(1, memory_order_relaxed);
+    if (void* block = malloc(size ? size : 1)) return block;
+    throw bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* block) noexcept { free(block); }
+void operator delete[](void* block) noexcept { free(block); }
+void operator delete(void* block, size_t) noexcept { free(block); }
+void operator delete[](void* block, size_t) noexcept { free(block); }
+#pragma GCC diagnostic pop
+
+static double elapsedMs(chrono::steady_clock::time_point since) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - since).count();
+}
+
+// Nearest-rank percentiles of latencies in microseconds: the p-th percentile is the
+// ceil(p * n)-th smallest sample, counting from 1
+static LatencySummary summarise(vector<double> samples) {
+    LatencySummary summary;
+    if (samples.empty()) return summary;
+    sort(samples.begin(), samples.end());
+    auto rank = [&samples](double p) {
+        // The small margin keeps products like 0.07 * 100 = 7.000000000000001 on rank 7
+        size_t nth = max<size_t>(1, static_cast<size_t>(ceil(p * samples.size() - 1e-9)));
+        return samples[min(nth, samples.size()) - 1];
+    };
+    double total = 0;
+    for (double sample : samples) total += sample;
+    summary.mean = total / samples.size();
+    summary.p50 = rank(0.50);
+    summary.p90 = rank(0.90);
+    summary.p99 = rank(0.99);
+    summary.max = samples.back();
+    return summary;
+}
+
+static string jsonString(const string& text) {
+    string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+static string jsonNumber(double value) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.3f", value);
+    return text;
+}
+
+// Per-query averages of a batch's hardware counters, or null where a counter is missing
+static string jsonCounters(const HardwareCounts& counts, size_t queries) {
+    if (!counts.measured || queries == 0) return "null";
+    auto perQuery = [queries](long long total) { return total < 0 ? string("null") : jsonNumber(static_cast<double>(total) / queries); };
+    return "{\"cycles\": " + perQuery(counts.cycles) + ", \"instructions\": " + perQuery(counts.instructions) +
+           ", \"ipc\": " + (counts.cycles > 0 && counts.instructions >= 0 ? jsonNumber(counts.ipc()) : string("null")) +
+           ", \"cache_references\": " + perQuery(counts.cache_references) + ", \"cache_misses\": " + perQuery(counts.cache_misses) +
+           ", \"branches\": " + perQuery(counts.branches) + ", \"branch_misses\": " + perQuery(counts.branch_misses) + "}";
+}
+
+static string jsonLatency(const LatencySummary& summary) {
+    return "{\"mean\": " + jsonNumber(summary.mean) + ", \"p50\": " + jsonNumber(summary.p50) +
+           ", \"p90\": " + jsonNumber(summary.p90) + ", \"p99\": " + jsonNumber(summary.p99) +
+           ", \"max\": " + jsonNumber(summary.max) + "}";
+}
+
+// Copy graph into other ID and weight types and time RouteSearch Dijkstra on the copy, checking
+// every total against expected; "null" if the weights do not fit
+template <class Id, class Weight>
+static string benchmarkCompact(const Graph& graph, const vector<pair<int, int>>& pairs, const vector<double>& expected) {
+    BasicGraph<Id, Weight> compact;
+    if (!compact.copyFrom(graph)) return "null";
+    BasicRouteSearch<Id, Weight> search(compact);
+    PathDetails route;
+    for (const pair<int, int>& query : pairs) search.Dijkstra(query.first, query.second, route);
+
+    vector<double> dijkstra_us;
+    for (size_t i = 0; i < pairs.size(); i++) {
+        auto started = chrono::steady_clock::now();
+        search.Dijkstra(pairs[i].first, pairs[i].second, route);
+        dijkstra_us.push_back(elapsedMs(started) * 1000.0);
+        if (route.total_weight != expected[i]) compact_mismatches++;
+        benchmark_sink += route.num_stops;
+    }
+    return "{\"bytes\": " + to_string(compact.sizeInBytes()) + ", \"dijkstra_us\": " + jsonLatency(summarise(dijkstra_us)) + "}";
+}
+
+// Map::map_to_graph reports on cout; keep that out of the JSON
+static bool loadQuietly(const BenchMap& map_files, Graph& graph) {
+    ostringstream discarded;
+    streambuf* saved = cout.rdbuf(discarded.rdbuf());
+    Map map(map_files.nodes_filename, map_files.edges_filename);
+    bool loaded = map.map_to_graph(graph);
+    cout.rdbuf(saved);
+    return loaded;
+}
+
+// Measure one map and return its JSON object, or "" if it does not load
+static string benchmarkMap(const BenchMap& map_files, const BenchOptions& options) {
+    vector<double> load_ms;
+    Graph graph;
+    for (int i = 0; i < options.repeat; i++) {
+        Graph loaded;
+        auto started = chrono::steady_clock::now();
+        if (!loadQuietly(map_files, loaded)) {
+            cerr << "Error: Could not load map '" << map_files.name << "'; skipping it." << endl;
+            return "";
+        }
+        load_ms.push_back(elapsedMs(started));
+        if (i == options.repeat - 1) graph = move(loaded);
+    }
+    sort(load_ms.begin(), load_ms.end());
+
+    int num_stops = graph.getNumNodes();
+    long long num_edges = 0;
+    for (int id = 0; id < num_stops; id++) num_edges += graph.getEdges(id).size();
+    num_edges /= 2; // Every road is stored on both ends
+
+    mt19937 rng(options.seed);
+    uniform_int_distribution<int> anyStop(0, max(0, num_stops - 1));
+    vector<pair<int, int>> pairs;
+    for (int i = 0; i < options.queries && num_stops > 0; i++) pairs.push_back({anyStop(rng), anyStop(rng)});
+
+    // The counters are switched on and off outside the clock readings, so latencies do not pay for it
+    PerfCounters& counters = PerfCounters::forThisThread();
+    HardwareCounts dijkstra_counts, bfs_counts;
+    vector<double> dijkstra_us, bfs_us;
+    int reachable = 0;
+    for (const pair<int, int>& query : pairs) {
+        counters.start();
+        auto started = chrono::steady_clock::now();
+        PathDetails path = graph.Dijkstra(query.first, query.second);
+        dijkstra_us.push_back(elapsedMs(started) * 1000.0);
+        dijkstra_counts.add(counters.stop());
+        if (path.path_exists) reachable++;
+        benchmark_sink += path.num_stops;
+
+        counters.start();
+        started = chrono::steady_clock::now();
+        path = graph.BFS(query.first, query.second);
+        bfs_us.push_back(elapsedMs(started) * 1000.0);
+        bfs_counts.add(counters.stop());
+        benchmark_sink += path.num_stops;
+    }
+
+    // The same queries with reused buffers: one untimed pass to warm them up, then the timed pass,
+    // which must not allocate. The latency vectors are sized first so they do not count.
+    RouteSearch search(graph);
+    PathDetails route;
+    for (const pair<int, int>& query : pairs) {
+        search.Dijkstra(query.first, query.second, route);
+        search.BFS(query.first, query.second, route);
+    }
+    vector<double> dijkstra_reused_us, bfs_reused_us, route_weights;
+    dijkstra_reused_us.reserve(pairs.size());
+    bfs_reused_us.reserve(pairs.size());
+    route_weights.reserve(pairs.size());
+    long long allocations_before = heap_allocations.load();
+    for (const pair<int, int>& query : pairs) {
+        auto started = chrono::steady_clock::now();
+        search.Dijkstra(query.first, query.second, route);
+        dijkstra_reused_us.push_back(elapsedMs(started) * 1000.0);
+        route_weights.push_back(route.total_weight);
+        benchmark_sink += route.num_stops;
+
+        started = chrono::steady_clock::now();
+        search.BFS(query.first, query.second, route);
+        bfs_reused_us.push_back(elapsedMs(started) * 1000.0);
+        benchmark_sink += route.num_stops;
+    }
+    long long reused_allocations = heap_allocations.load() - allocations_before;
+    reused_buffer_allocations += reused_allocations;
+
+    string compact_uint32 = benchmarkCompact<uint32_t, uint32_t>(graph, pairs, route_weights);
+    string compact_float = benchmarkCompact<uint32_t, float>(graph, pairs, route_weights);
+
+    // Exact lookups: names of random stops, then the same names with a suffix no stop has
+    const int LOOKUPS = 200000;
+    vector<string> names;
+    for (int i = 0; i < 1024 && num_stops > 0; i++) names.push_back(string(graph.getNodeName(anyStop(rng))));
+    double hits_per_second = 0, misses_per_second = 0;
+    if (!names.empty()) {
+        auto started = chrono::steady_clock::now();
+        for (int i = 0; i < LOOKUPS; i++) benchmark_sink += graph.getNodeIndexByname(names[i % names.size()]);
+        hits_per_second = LOOKUPS / (elapsedMs(started) / 1000.0);
+        for (string& name : names) name += "#missing";
+        started = chrono::steady_clock::now();
+        for (int i = 0; i < LOOKUPS; i++) benchmark_sink += graph.getNodeIndexByname(names[i % names.size()]);
+        misses_per_second = LOOKUPS / (elapsedMs(started) / 1000.0);
+    }
+
+    string matrix_ms = "null";
+    if (num_stops <= options.matrix_limit) {
+        auto started = chrono::steady_clock::now();
+        Graph::AdjacencyMatrix matrix = graph.createAdjacencyMatrix();
+        matrix_ms = jsonNumber(elapsedMs(started));
+        benchmark_sink += static_cast<long long>(matrix.size());
+    }
+
+    ostringstream json;
+    json << "    {\"name\": " << jsonString(map_files.name)
+         << ", \"source\": " << jsonString(map_files.source)
+         << ", \"nodes\": " << num_stops
+         << ", \"edges\": " << num_edges
+         << ", \"bytes\": " << graph.sizeInBytes()
+         << ",\n     \"load_ms\": {\"min\": " << jsonNumber(load_ms.front())
+         << ", \"median\": " << jsonNumber(load_ms[load_ms.size() / 2]) << ", \"runs\": " << load_ms.size() << "}"
+         << ",\n     \"queries\": " << pairs.size() << ", \"reachable\": " << reachable
+         << ",\n     \"dijkstra_us\": " << jsonLatency(summarise(dijkstra_us))
+         << ",\n     \"bfs_us\": " << jsonLatency(summarise(bfs_us))
+         << ",\n     \"dijkstra_counters\": " << jsonCounters(dijkstra_counts, pairs.size())
+         << ",\n     \"bfs_counters\": " << jsonCounters(bfs_counts, pairs.size())
+         << ",\n     \"dijkstra_reused_us\": " << jsonLatency(summarise(dijkstra_reused_us))
+         << ",\n     \"bfs_reused_us\": " << jsonLatency(summarise(bfs_reused_us))
+         << ", \"reused_allocations\": " << reused_allocations
+         << ",\n     \"compact_uint32\": " << compact_uint32
+         << ",\n     \"compact_float\": " << compact_float
+         << ",\n     \"name_lookup\": {\"lookups\": " << (names.empty() ? 0 : LOOKUPS)
+         << ", \"hits_per_sec\": " << jsonNumber(hits_per_second)
+         << ", \"misses_per_sec\": " << jsonNumber(misses_per_second) << "}"
+         << ",\n     \"adjacency_matrix_ms\": " << matrix_ms << "}";
+    return json.str();
+}
+
+static bool parseKinds(const string& list, BenchOptions& options) {
+    options.kinds.clear();
+    options.kind_names.clear();
+    stringstream ss(list);
+    string item;
+    while (getline(ss, item, ',')) {
+        NetworkKind kind;
+        if (!NetworkGenerator::parseKind(item, kind)) return false;
+        options.kinds.push_back(kind);
+        options.kind_names.push_back(item);
+    }
+    return !options.kinds.empty();
+}
+
+static bool parseSizes(const string& list, vector<int>& sizes) {
+    sizes.clear();
+    stringstream ss(list);
+    string item;
+    while (getline(ss, item, ',')) {
+        int size = atoi(item.c_str());
+        if (size < 2) return false;
+        sizes.push_back(size);
+    }
+    return !sizes.empty();
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    vector<string> files;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--sizes" && i + 1 < argc) {
+            if (!parseSizes(argv[++i], options.sizes)) {
+                cerr << "Error: --sizes takes a comma-separated list of stop counts of at least 2." << endl;
+                return 1;
+            }
+        } else if (arg == "--kinds" && i + 1 < argc) {
+            if (!parseKinds(argv[++i], options)) {
+                cerr << "Error: --kinds takes a comma-separated list of grid, geometric, hub-and-spoke, scale-free." << endl;
+                return 1;
+            }
+        } else if (arg == "--queries" && i + 1 < argc) {
+            options.queries = max(1, atoi(argv[++i]));
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            options.repeat = max(1, atoi(argv[++i]));
+        } else if (arg == "--matrix-limit" && i + 1 < argc) {
+            options.matrix_limit = atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--out" && i + 1 < argc) {
+            options.out_filename = argv[++i];
+        } else if (arg == "--no-generated") {
+            options.generated = false;
+        } else if (arg.rfind("--", 0) == 0) {
+            cerr << "Usage: " << argv[0] << " [--sizes n,n,...] [--kinds k,k,...] [--queries n] [--repeat n] [--matrix-limit n]"
+                 << " [--seed n] [--out file.json] [--no-generated] [map files...]" << endl;
+            return 1;
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    vector<BenchMap> maps;
+    for (size_t i = 0; i < files.size(); i++) {
+        if (Map::detectFormat(files[i]) == MAP_FORMAT_SPLIT_FILES) {
+            if (i + 1 == files.size()) {
+                cerr << "Error: '" << files[i] << "' needs an edges file after it." << endl;
+                return 1;
+            }
+            maps.push_back(BenchMap{files[i] + " + " + files[i + 1], "command line", files[i], files[i + 1]});
+            i++;
+        } else {
+            maps.push_back(BenchMap{files[i], "command line", files[i], ""});
+        }
+    }
+    if (files.empty()) {
+        if (ifstream("nodes.txt").is_open() && ifstream("edges.txt").is_open()) {
+            maps.push_back(BenchMap{"nodes.txt + edges.txt", "bundled", "nodes.txt", "edges.txt"});
+        }
+        if (ifstream("Summer_Routes.txt").is_open()) {
+            maps.push_back(BenchMap{"Summer_Routes.txt", "bundled", "Summer_Routes.txt", ""});
+        }
+    }
+
+    vector<string> generated_files;
+    if (options.generated) {
+        filesystem::path directory = filesystem::temp_directory_path();
+        for (size_t k = 0; k < options.kinds.size(); k++) {
+            for (int size : options.sizes) {
+                string name = options.kind_names[k] + "-" + to_string(size);
+                string stem = (directory / ("commute_bench_" + name)).string();
+                BenchMap network{name, "generated", stem + "_nodes.txt", stem + "_edges.txt"};
+                NetworkSpec spec;
+                spec.kind = options.kinds[k];
+                spec.num_stops = size;
+                spec.seed = options.seed;
+                spec.threads = max(1u, thread::hardware_concurrency());
+                NetworkGenerator generator(spec);
+                if (!generator.writeSplitFiles(generator.generate(), network.nodes_filename, network.edges_filename)) return 1;
+                generated_files.push_back(network.nodes_filename);
+                generated_files.push_back(network.edges_filename);
+                maps.push_back(network);
+            }
+        }
+    }
+    if (maps.empty()) {
+        cerr << "Error: Nothing to benchmark. Name a map file or drop --no-generated." << endl;
+        return 1;
+    }
+
+    vector<string> results;
+    for (const BenchMap& map_files : maps) {
+        cerr << "Benchmarking " << map_files.name << "..." << endl;
+        string result = benchmarkMap(map_files, options);
+        if (!result.empty()) results.push_back(result);
+    }
+    for (const string& filename : generated_files) {
+        remove(filename.c_str());
+    }
+
+    ostringstream report;
+    report << "{\n  \"seed\": " << options.seed << ", \"queries\": " << options.queries
+           << ", \"repeat\": " << options.repeat << ",\n  \"hardware_counters\": ";
+    PerfCounters& counters = PerfCounters::forThisThread();
+    if (counters.available()) {
+        report << "{\"available\": true}";
+    } else {
+        report << "{\"available\": false, \"reason\": " << jsonString(counters.unavailableReason()) << "}";
+    }
+    report << ",\n  \"maps\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        report << results[i] << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    report << "  ]\n}\n";
+
+    if (options.out_filename.empty()) {
+        cout << report.str();
+    } else {
+        ofstream outFile(options.out_filename);
+        if (!outFile.is_open()) {
+            cerr << "Error: Could not open '" << options.out_filename << "' for writing." << endl;
+            return 1;
+        }
+        outFile << report.str();
+    }
+    if (compact_mismatches != 0) {
+        cerr << "Error: " << compact_mismatches << " routes on the compact graphs had a different total from the original." << endl;
+        return 1;
+    }
+    if (reused_buffer_allocations != 0) {
+        cerr << "Error: RouteSearch made " << reused_buffer_allocations << " heap allocations after warm-up; it should make none." << endl;
+        return 1;
+    }
+    return results.size() == maps.size() ? 0 : 1;
+}
@@ -0,0 +1,332 @@
+#ifndef CSA_H
+#define CSA_H
+
+#include <algorithm>
+#include <vector>
+#include <string>
+#include "timetable.h"
+#include "trace.h"
+
+using namespace std;
+
+// One bus driving from a stop to the next stop of its route without stopping in between
+struct Connection {
+    int departure_stop_id;
+    int arrival_stop_id;
+    int departure_time;
+    int arrival_time;
+    int trip_id;        // Global trip number, unique across routes
+    int route_id;
+    int stop_index;     // Position of the departure stop along the route
+};
+
+// Connection Scan Algorithm.
+// All connections sit in one array sorted by departure time, so an earliest-arrival query is a
+// single forward pass over contiguous memory with no priority queue. The pass stops as soon as
+// connections depart after the best arrival at the target.
+class ConnectionScanEngine {
+private:
+    // A walk keeps the ride that reached its first stop, since that stop's own pointer may be
+    // an earlier walk and walks never chain
+    struct JourneyPointer {
+        int enter_connection = -1;  // Trip ride: first and last connection used
+        int exit_connection = -1;
+        int walk_from_stop_id = -1; // Footpath: stop walked from
+    };
+
+    const Timetable& timetable;
+    vector<Connection> connections;
+
+    vector<int> stop_arrival;
+    vector<int> ride_arrival;       // Earliest arrival by a ride (or at the origin); walks start from these
+    vector<JourneyPointer> pointers;
+    vector<int> trip_entry;         // Connection where each trip was boarded, -1 if not reached
+    vector<int> touched_stops;
+    vector<int> touched_trips;
+    SearchStats last_stats;
+
+    void reset() {
+        for (int s : touched_stops) {
+            stop_arrival[s] = TIME_INF;
+            ride_arrival[s] = TIME_INF;
+            pointers[s] = JourneyPointer();
+        }
+        for (int t : touched_trips) trip_entry[t] = -1;
+        touched_stops.clear();
+        touched_trips.clear();
+    }
+
+    void improve(int stop_id, int time, const JourneyPointer& pointer) {
+        if (stop_arrival[stop_id] == TIME_INF) touched_stops.push_back(stop_id);
+        stop_arrival[stop_id] = time;
+        pointers[stop_id] = pointer;
+    }
+
+    // Walk on from a ride that reached stop_id at time; ride is its pointer (empty at the origin)
+    template <class Stats>
+    void walkFrom(int stop_id, int time_at_stop, const JourneyPointer& ride, Stats& counters) {
+        for (int f = timetable.footpath_offset[stop_id]; f < timetable.footpath_offset[stop_id + 1]; f++) {
+            const Footpath& walk = timetable.footpaths[f];
+            int time = time_at_stop + walk.duration;
+            counters.relaxed();
+            if (time < stop_arrival[walk.destination_stop_id]) {
+                JourneyPointer pointer = ride;
+                pointer.walk_from_stop_id = stop_id;
+                improve(walk.destination_stop_id, time, pointer);
+                counters.settled();
+            }
+        }
+    }
+
+    Journey buildJourney(int source_stop_id, int target_stop_id, int departure_time) const {
+        Journey journey;
+        if (stop_arrival[target_stop_id] == TIME_INF) return journey;
+
+        journey.journey_exists = true;
+        journey.departure_time = departure_time;
+        journey.arrival_time = stop_arrival[target_stop_id];
+
+        // Legs come out backwards; a walk pointer yields the walk and then the ride before it
+        int stop_id = target_stop_id;
+        while (stop_id != source_stop_id) {
+            const JourneyPointer& pointer = pointers[stop_id];
+            if (pointer.walk_from_stop_id != -1) {
+                JourneyLeg walk;
+                walk.board_stop_id = pointer.walk_from_stop_id;
+                walk.alight_stop_id = stop_id;
+                walk.board_time = pointer.exit_connection != -1 ? connections[pointer.exit_connection].arrival_time
+                                                                : departure_time;
+                walk.alight_time = stop_arrival[stop_id];
+                journey.legs.push_back(walk);
+            }
+            if (pointer.enter_connection != -1) {
+                const Connection& enter = connections[pointer.enter_connection];
+                const Connection& exit = connections[pointer.exit_connection];
+                JourneyLeg leg;
+                leg.route_id = enter.route_id;
+                leg.board_stop_id = enter.departure_stop_id;
+                leg.alight_stop_id = exit.arrival_stop_id;
+                leg.board_time = enter.departure_time;
+                leg.alight_time = exit.arrival_time;
+                journey.legs.push_back(leg);
+                stop_id = enter.departure_stop_id;
+            } else if (pointer.walk_from_stop_id != -1) {
+                stop_id = pointer.walk_from_stop_id;
+            } else {
+                break;
+            }
+        }
+        reverse(journey.legs.begin(), journey.legs.end());
+
+        if (!journey.legs.empty() && journey.legs.front().route_id != -1) {
+            journey.departure_time = journey.legs.front().board_time;
+        }
+
+        // Expand rides into the stops they pass, walking the stored connection pointers again
+        journey.node_ids_in_path.push_back(source_stop_id);
+        int trips = 0;
+        stop_id = target_stop_id;
+        vector<int> reversed_stops;
+        while (stop_id != source_stop_id) {
+            const JourneyPointer& pointer = pointers[stop_id];
+            if (pointer.walk_from_stop_id != -1) reversed_stops.push_back(stop_id);
+            if (pointer.enter_connection != -1) {
+                const Connection& enter = connections[pointer.enter_connection];
+                const Connection& exit = connections[pointer.exit_connection];
+                for (int i = exit.stop_index + 1; i > enter.stop_index; i--) {
+                    reversed_stops.push_back(timetable.getRouteStop(enter.route_id, i));
+                }
+                stop_id = enter.departure_stop_id;
+                trips++;
+            } else if (pointer.walk_from_stop_id != -1) {
+                stop_id = pointer.walk_from_stop_id;
+            } else {
+                break;
+            }
+        }
+        journey.node_ids_in_path.insert(journey.node_ids_in_path.end(), reversed_stops.rbegin(), reversed_stops.rend());
+        journey.num_transfers = max(0, trips - 1);
+        return journey;
+    }
+
+    // Forward scan for earliestArrival; the stop IDs are already checked
+    template <class Stats>
+    Journey scan(int source_stop_id, int target_stop_id, int departure_time, Stats& counters) {
+        reset();
+        improve(source_stop_id, departure_time, JourneyPointer());
+        ride_arrival[source_stop_id] = departure_time;
+        counters.settled();
+        walkFrom(source_stop_id, departure_time, JourneyPointer(), counters);
+
+        // Jump straight to the first connection we could possibly catch
+        auto first = lower_bound(connections.begin(), connections.end(), departure_time,
+                                 [](const Connection& c, int time) { return c.departure_time < time; });
+
+        for (size_t i = first - connections.begin(); i < connections.size(); i++) {
+            const Connection& c = connections[i];
+            counters.relaxed();
+            if (c.departure_time >= stop_arrival[target_stop_id]) {
+                break; // Nothing departing now can arrive earlier
+            }
+            if (trip_entry[c.trip_id] == -1) {
+                if (stop_arrival[c.departure_stop_id] > c.departure_time) continue;
+                trip_entry[c.trip_id] = static_cast<int>(i);
+                touched_trips.push_back(c.trip_id);
+            }
+            // A stop reached earlier on foot still lets this ride walk on, as in RAPTOR
+            if (c.arrival_time < ride_arrival[c.arrival_stop_id]) {
+                JourneyPointer pointer;
+                pointer.enter_connection = trip_entry[c.trip_id];
+                pointer.exit_connection = static_cast<int>(i);
+                if (c.arrival_time < stop_arrival[c.arrival_stop_id]) {
+                    improve(c.arrival_stop_id, c.arrival_time, pointer);
+                    counters.settled();
+                }
+                ride_arrival[c.arrival_stop_id] = c.arrival_time;
+                walkFrom(c.arrival_stop_id, c.arrival_time, pointer, counters);
+            }
+        }
+
+        return buildJourney(source_stop_id, target_stop_id, departure_time);
+    }
+
+public:
+    ConnectionScanEngine(const Timetable& tt) : timetable(tt) {
+        int num_trips = 0;
+        for (int r = 0; r < tt.getNumRoutes(); r++) {
+            int length = tt.getRouteLength(r);
+            for (int t = 0; t < tt.getNumTrips(r); t++, num_trips++) {
+                for (int i = 0; i + 1 < length; i++) {
+                    connections.push_back(Connection{tt.getRouteStop(r, i), tt.getRouteStop(r, i + 1),
+                                                     tt.getTripTime(r, t, i), tt.getTripTime(r, t, i + 1),
+                                                     num_trips, r, i});
+                }
+            }
+        }
+        // Ties keep route order so connections of one trip stay in sequence even with
+        // zero-minute hops
+        stable_sort(connections.begin(), connections.end(), [](const Connection& a, const Connection& b) {
+            return a.departure_time < b.departure_time;
+        });
+
+        stop_arrival.assign(tt.numStops, TIME_INF);
+        ride_arrival.assign(tt.numStops, TIME_INF);
+        pointers.assign(tt.numStops, JourneyPointer());
+        trip_entry.assign(num_trips, -1);
+    }
+
+    int getNumConnections() const { return static_cast<int>(connections.size()); }
+
+    // Earliest arrival at target leaving source no earlier than departure_time
+    template <class Stats = NoSearchStats>
+    Journey earliestArrival(int source_stop_id, int target_stop_id, int departure_time) {
+        TraceSpan span("CSA earliest arrival", "search");
+        Stats counters;
+        Journey result;
+        int n = timetable.numStops;
+        if (source_stop_id < 0 || target_stop_id < 0 || source_stop_id >= n || target_stop_id >= n) {
+            cerr << "Error: Invalid stop ID in connection scan query." << endl;
+            return result;
+        }
+        result = scan(source_stop_id, target_stop_id, departure_time, counters);
+        counters.finish(result.stats);
+        return result;
+    }
+
+    // Every non-dominated journey leaving source within [window_start, window_end].
+    // Profile CSA scans connections backwards once, keeping per stop the Pareto list of
+    // (departure, arrival at target) pairs; each resulting departure is then expanded into legs
+    // with an early-terminating forward scan. Stats for the whole profile go to lastStats().
+    template <class Stats = NoSearchStats>
+    vector<Journey> profile(int source_stop_id, int target_stop_id, int window_start, int window_end) {
+        TraceSpan span("CSA profile", "search");
+        Stats counters;
+        last_stats = SearchStats();
+        vector<Journey> journeys;
+        int n = timetable.numStops;
+        if (source_stop_id < 0 || target_stop_id < 0 || source_stop_id >= n || target_stop_id >= n) {
+            cerr << "Error: Invalid stop ID in connection scan profile query." << endl;
+            return journeys;
+        }
+
+        // Walking time from each stop straight to the target
+        vector<int> walk_to_target(n, TIME_INF);
+        walk_to_target[target_stop_id] = 0;
+        for (int f = timetable.footpath_offset[target_stop_id]; f < timetable.footpath_offset[target_stop_id + 1]; f++) {
+            const Footpath& walk = timetable.footpaths[f];
+            walk_to_target[walk.destination_stop_id] = min(walk_to_target[walk.destination_stop_id], walk.duration);
+        }
+
+        // profiles[s] is ordered by decreasing departure and strictly decreasing arrival
+        vector<vector<pair<int, int>>> profiles(n);
+        vector<int> trip_arrival(trip_entry.size(), TIME_INF);
+
+        auto evaluate = [&](int stop_id, int time) {
+            const vector<pair<int, int>>& p = profiles[stop_id];
+            // Last entry still departing at or after time has the earliest arrival
+            int low = 0, high = static_cast<int>(p.size());
+            while (low < high) {
+                int mid = (low + high) / 2;
+                if (p[mid].first >= time) low = mid + 1;
+                else high = mid;
+            }
+            return low == 0 ? TIME_INF : p[low - 1].second;
+        };
+        // Pareto insert at the pair's place in the order. Connections arrive by decreasing
+        // departure, but footpaths shift departures earlier by their walk, so a pair can belong
+        // anywhere in the list, not only at the back.
+        auto insert = [&](int stop_id, int departure, int arrival) {
+            vector<pair<int, int>>& p = profiles[stop_id];
+            auto departsLater = [](const pair<int, int>& entry, int time) { return entry.first > time; };
+            size_t at = lower_bound(p.begin(), p.end(), departure, departsLater) - p.begin();
+            // Earliest arrival among entries leaving no earlier: the equal departure, else the
+            // one before
+            int rival = at < p.size() && p[at].first == departure ? p[at].second : (at > 0 ? p[at - 1].second : TIME_INF);
+            if (rival <= arrival) return;
+            // Entries leaving no later and arriving no earlier are dominated; they follow at
+            // directly
+            size_t dominated_end = at;
+            while (dominated_end < p.size() && p[dominated_end].second >= arrival) dominated_end++;
+            if (dominated_end > at) {
+                p[at] = {departure, arrival};
+                p.erase(p.begin() + at + 1, p.begin() + dominated_end);
+            } else {
+                p.insert(p.begin() + at, {departure, arrival});
+            }
+        };
+
+        for (size_t i = connections.size(); i-- > 0;) {
+            const Connection& c = connections[i];
+            if (c.departure_time < window_start) break;
+            counters.relaxed();
+
+            int by_walking = walk_to_target[c.arrival_stop_id] == TIME_INF ? TIME_INF
+                                                                          : c.arrival_time + walk_to_target[c.arrival_stop_id];
+            int best = min(by_walking, trip_arrival[c.trip_id]);
+            best = min(best, evaluate(c.arrival_stop_id, c.arrival_time));
+            if (best == TIME_INF) continue;
+
+            trip_arrival[c.trip_id] = best;
+            insert(c.departure_stop_id, c.departure_time, best);
+            counters.settled();
+            for (int f = timetable.footpath_offset[c.departure_stop_id]; f < timetable.footpath_offset[c.departure_stop_id + 1]; f++) {
+                const Footpath& walk = timetable.footpaths[f];
+                insert(walk.destination_stop_id, c.departure_time - walk.duration, best);
+            }
+        }
+
+        const vector<pair<int, int>>& source_profile = profiles[source_stop_id];
+        for (size_t i = source_profile.size(); i-- > 0;) {
+            int departure = source_profile[i].first;
+            if (departure < window_start || departure > window_end) continue;
+            journeys.push_back(scan(source_stop_id, target_stop_id, departure, counters));
+        }
+        counters.finish(last_stats);
+        return journeys;
+    }
+
+    // Instrumentation of the last profile query; collected only when it ran with CountSearchStats
+    const SearchStats& lastStats() const { return last_stats; }
+};
+
+#endif // CSA_H
@@ -0,0 +1,196 @@
+#ifndef FUZZY_MATCH_H
+#define FUZZY_MATCH_H
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include "graphV1.h"
+
+using namespace std;
+
+// A stop whose name is close to what was typed
+struct FuzzyMatch {
+    int node_id;
+    int distance;   // Fewest edits turning the typed text into the name or into part of it
+};
+
+// Edit distance from pattern to text with Myers' bit-parallel algorithm (Hyyro's formulation):
+// one machine word holds a whole DP column, so a text character costs a handful of word operations.
+// Reports the distance to all of text (whole) and the smallest distance to any part of text
+// (anywhere = true) or to any prefix of it (anywhere = false), which suits half-typed or partial names.
+// Patterns longer than 64 characters use the plain dynamic programme.
+inline void editDistance(const string& pattern, const string& text, bool anywhere, int& whole, int& best) {
+    int m = static_cast<int>(pattern.size());
+    if (m == 0) {
+        whole = static_cast<int>(text.size());
+        best = 0;
+        return;
+    }
+
+    best = m;
+    if (m > 64) {
+        vector<int> column(m + 1);
+        for (int i = 0; i <= m; i++) column[i] = i;
+        for (size_t j = 0; j < text.size(); j++) {
+            int diagonal = column[0];
+            if (!anywhere) column[0]++;
+            for (int i = 1; i <= m; i++) {
+                int above = column[i];
+                column[i] = min(min(column[i] + 1, column[i - 1] + 1), diagonal + (pattern[i - 1] != text[j]));
+                diagonal = above;
+            }
+            best = min(best, column[m]);
+        }
+        whole = column[m];
+        return;
+    }
+
+    uint64_t peq[256] = {0};
+    for (int i = 0; i < m; i++) peq[static_cast<unsigned char>(pattern[i])] |= 1ULL << i;
+    uint64_t last = 1ULL << (m - 1);
+    uint64_t pv = ~0ULL, mv = 0;
+    uint64_t row_zero_step = anywhere ? 0 : 1;  // Row 0 is 0, 1, 2, ... or, matching anywhere, all zeros
+    int score = m;
+    for (unsigned char c : text) {
+        uint64_t eq = peq[c];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        if (ph & last) score++;
+        else if (mh & last) score--;
+        ph = (ph << 1) | row_zero_step;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+        best = min(best, score);
+    }
+    whole = score;
+}
+
+// Approximate stop-name lookup for when the exact name is not found.
+//
+// Names are normalised (lower case, any run of spaces, underscores, dashes or dots becomes one
+// underscore) and split into padded trigrams. An inverted index from trigram to stops gives
+// candidates: the stops sharing the most trigrams with the query. Only those are ranked by edit
+// distance, so a lookup touches a few posting lists instead of every name.
+//
+// The index follows the graph by indexing nodes added since the last call, so one matcher can be
+// reused across versions of a graph that only grows. It is not safe to share between threads.
+class FuzzyNameMatcher {
+private:
+    unordered_map<uint32_t, vector<int>> postings;  // Trigram -> stops, ascending IDs
+    vector<string> normalised;                      // Per stop
+    vector<uint16_t> hits;                          // Shared trigrams, per stop, during a search
+    vector<int> touched;
+
+    static const int MAX_CANDIDATES = 64;           // Stops ranked by edit distance per search
+
+    static void trigrams(const string& name, vector<uint32_t>& out) {
+        out.clear();
+        string padded = "  " + name + " ";
+        for (size_t i = 0; i + 2 < padded.size(); i++) {
+            out.push_back((static_cast<uint32_t>(static_cast<unsigned char>(padded[i])) << 16) |
+                          (static_cast<uint32_t>(static_cast<unsigned char>(padded[i + 1])) << 8) |
+                          static_cast<unsigned char>(padded[i + 2]));
+        }
+        sort(out.begin(), out.end());
+        out.erase(unique(out.begin(), out.end()), out.end());
+    }
+
+    // Index stops added to the graph since the last call
+    void sync(const Graph& graph) {
+        int numNodes = graph.getNumNodes();
+        vector<uint32_t> grams;
+        for (int id = static_cast<int>(normalised.size()); id < numNodes; id++) {
+            normalised.push_back(normalise(graph.getNodeName(id)));
+            trigrams(normalised.back(), grams);
+            for (uint32_t gram : grams) postings[gram].push_back(id);
+        }
+        hits.resize(numNodes, 0);
+    }
+
+public:
+    FuzzyNameMatcher() = default;
+
+    // Whether the best match is closer than every other, so it is safe to use without asking
+    static bool clearlyBest(const vector<FuzzyMatch>& matches) {
+        return !matches.empty() && (matches.size() == 1 || matches[0].distance < matches[1].distance);
+    }
+
+    static string normalise(string_view name) {
+        string out;
+        out.reserve(name.size());
+        for (unsigned char c : name) {
+            if (isalnum(c)) {
+                out += static_cast<char>(tolower(c));
+            } else if ((c == ' ' || c == '_' || c == '-' || c == '.') && !out.empty() && out.back() != '_') {
+                out += '_';
+            }
+        }
+        if (!out.empty() && out.back() == '_') out.pop_back();
+        return out;
+    }
+
+    // Up to limit stops closest to query, best first. Stops further than max_distance edits are
+    // left out; -1 picks a bound from the query length (about one edit per four characters).
+    vector<FuzzyMatch> search(const Graph& graph, const string& query, size_t limit = 5, int max_distance = -1) {
+        TraceSpan span("Fuzzy name match", "search");
+        sync(graph);
+        vector<FuzzyMatch> matches;
+        string key = normalise(query);
+        if (key.empty() || limit == 0) return matches;
+        if (max_distance < 0) max_distance = max(1, static_cast<int>(key.size() + 2) / 4);
+
+        vector<uint32_t> grams;
+        trigrams(key, grams);
+        for (uint32_t gram : grams) {
+            auto list = postings.find(gram);
+            if (list == postings.end()) continue;
+            for (int id : list->second) {
+                if (hits[id]++ == 0) touched.push_back(id);
+            }
+        }
+
+        // Keep the stops sharing the most trigrams
+        auto moreHits = [this](int a, int b) { return hits[a] != hits[b] ? hits[a] > hits[b] : a < b; };
+        if (touched.size() > static_cast<size_t>(MAX_CANDIDATES)) {
+            nth_element(touched.begin(), touched.begin() + MAX_CANDIDATES, touched.end(), moreHits);
+        }
+        // Rank by edits; at equal edits a whole name beats a name that starts like the query,
+        // which beats one that only contains it, and shorter names come first
+        struct Ranked {
+            FuzzyMatch match;
+            int tier;
+        };
+        vector<Ranked> ranked;
+        size_t candidates = min(touched.size(), static_cast<size_t>(MAX_CANDIDATES));
+        for (size_t i = 0; i < candidates; i++) {
+            int id = touched[i];
+            int whole, prefix, suffix, part;
+            editDistance(key, normalised[id], false, whole, prefix);
+            editDistance(key, normalised[id], true, suffix, part);
+            int edits = min(whole, min(prefix, part));
+            if (edits > max_distance) continue;
+            ranked.push_back(Ranked{FuzzyMatch{id, edits}, whole == edits ? 0 : prefix == edits ? 1 : 2});
+        }
+        for (int id : touched) hits[id] = 0;
+        touched.clear();
+
+        sort(ranked.begin(), ranked.end(), [this](const Ranked& a, const Ranked& b) {
+            if (a.match.distance != b.match.distance) return a.match.distance < b.match.distance;
+            if (a.tier != b.tier) return a.tier < b.tier;
+            size_t a_length = normalised[a.match.node_id].size(), b_length = normalised[b.match.node_id].size();
+            if (a_length != b_length) return a_length < b_length;
+            return a.match.node_id < b.match.node_id;
+        });
+        for (size_t i = 0; i < ranked.size() && i < limit; i++) matches.push_back(ranked[i].match);
+        return matches;
+    }
+};
+
+#endif // FUZZY_MATCH_H
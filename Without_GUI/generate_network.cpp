@@ -0,0 +1,63 @@
+// Writes synthetic transit networks (network_gen.h) for scale testing and benchmark fixtures.
+//
+// Build: g++ -std=c++17 -O2 -pthread generate_network.cpp -o commute_gen
+// Run:   ./commute_gen --kind grid --stops 1000000 big_nodes.txt big_edges.txt
+//        ./commute_gen --kind scale-free --stops 2000000 --seed 7 --threads 8 --summer Big_Routes.txt
+//
+// Kinds: grid, geometric, hub-and-spoke (or hub), scale-free. Two file names give the
+// nodes.txt/edges.txt pair; --summer and one file name give the Summer_Routes.txt layout.
+// The university is stop 0 (named by --university) and every stop can reach it. The same seed and
+// stop count always give the same files, whatever --threads is.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include "network_gen.h"
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    NetworkSpec spec;
+    spec.threads = max(1u, thread::hardware_concurrency());
+    bool summer_format = false;
+    vector<string> files;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--kind" && i + 1 < argc) {
+            if (!NetworkGenerator::parseKind(argv[++i], spec.kind)) {
+                cerr << "Error: Unknown network kind '" << argv[i] << "' (grid, geometric, hub-and-spoke, scale-free)." << endl;
+                return 1;
+            }
+        } else if (arg == "--stops" && i + 1 < argc) {
+            spec.num_stops = atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            spec.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            spec.threads = static_cast<unsigned>(max(1, atoi(argv[++i])));
+        } else if (arg == "--university" && i + 1 < argc) {
+            spec.university_name = argv[++i];
+        } else if (arg == "--summer") {
+            summer_format = true;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.size() != (summer_format ? 1u : 2u) || spec.num_stops < 2) {
+        cerr << "Usage: " << argv[0] << " [--kind grid|geometric|hub-and-spoke|scale-free] [--stops n] [--seed n]"
+             << " [--threads n] [--university name] (<nodes file> <edges file> | --summer <map file>)" << endl;
+        return 1;
+    }
+
+    auto started = chrono::steady_clock::now();
+    NetworkGenerator generator(spec);
+    vector<GeneratedRoad> roads = generator.generate();
+    bool written = summer_format ? generator.writeSingleFile(roads, files[0])
+                                 : generator.writeSplitFiles(roads, files[0], files[1]);
+    if (!written) return 1;
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    cerr << "Wrote " << spec.num_stops << " stops and " << roads.size() << " roads to "
+         << (summer_format ? files[0] : files[0] + " and " + files[1]) << " in " << seconds << " s." << endl;
+    return 0;
+}
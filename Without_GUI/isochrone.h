@@ -0,0 +1,86 @@
+#ifndef ISOCHRONE_H
+#define ISOCHRONE_H
+
+#include <algorithm>
+#include <vector>
+#include "graphV1.h"
+#include "search_workspace.h"
+
+using namespace std;
+
+// Stops reachable from one centre within several nested time budgets.
+// Stops are listed once, in increasing distance; the stops within thresholds[i]
+// are the first counts[i] entries.
+struct IsochroneResult {
+    vector<double> thresholds;   // Ascending
+    vector<int> counts;
+    vector<int> node_ids;
+    vector<double> distances;
+    SearchStats stats;           // Filled when the search ran with CountSearchStats
+
+    IsochroneResult() = default;
+};
+
+// Bounded one-to-all search: Dijkstra settles stops in distance order, so it can stop the moment
+// the queue passes the largest threshold, and its settle order is already the sorted answer.
+class IsochroneSearch {
+private:
+    const Graph& graph;
+    SearchWorkspace ws;
+
+public:
+    IsochroneSearch(const Graph& g) : graph(g) {}
+
+    template <class Stats = NoSearchStats>
+    IsochroneResult search(int centerNodeId, vector<double> thresholds) {
+        TraceSpan span("Isochrone", "search");
+        Stats counters;
+        IsochroneResult result;
+        if (centerNodeId < 0 || centerNodeId >= graph.getNumNodes()) {
+            cerr << "Error: Invalid centre node ID in isochrone search." << endl;
+            return result;
+        }
+        sort(thresholds.begin(), thresholds.end());
+        thresholds.erase(unique(thresholds.begin(), thresholds.end()), thresholds.end());
+        if (thresholds.empty()) return result;
+        double budget = thresholds.back();
+
+        ws.prepare(graph.getNumNodes());
+        ws.update(centerNodeId, 0.0, -1);
+        ws.push(0.0, centerNodeId);
+        counters.pushed(ws.heap.size());
+        while (!ws.heap.empty()) {
+            SearchWorkspace::HeapEntry top = ws.pop();
+            counters.popped();
+            int u = top.second;
+            if (ws.isSettled(u)) {
+                counters.stale();
+                continue;
+            }
+            if (top.first > budget) break;
+            ws.settle(u);
+            counters.settled();
+            result.node_ids.push_back(u);
+            result.distances.push_back(top.first);
+            for (const Edge& edge : graph.getEdges(u)) {
+                counters.relaxed();
+                double d = top.first + edge.weight;
+                if (d <= budget && d < ws.distance(edge.destination_node_id)) {
+                    ws.update(edge.destination_node_id, d, u);
+                    ws.push(d, edge.destination_node_id);
+                    counters.pushed(ws.heap.size());
+                }
+            }
+        }
+
+        result.thresholds = thresholds;
+        for (double threshold : thresholds) {
+            result.counts.push_back(static_cast<int>(
+                upper_bound(result.distances.begin(), result.distances.end(), threshold) - result.distances.begin()));
+        }
+        counters.finish(result.stats);
+        return result;
+    }
+};
+
+#endif // ISOCHRONE_H
@@ -0,0 +1,277 @@
+#ifndef KSP_H
+#define KSP_H
+
+#include <algorithm>
+#include <vector>
+#include <set>
+#include <thread>
+#include <atomic>
+#include "graphV1.h"
+#include "search_workspace.h"
+
+using namespace std;
+
+// K shortest loopless paths (Yen's algorithm) to one destination.
+// One Dijkstra from the destination builds a reverse shortest-path tree that every spur search
+// reuses: its distances are exact lower bounds for A*, and whenever the tree path from a spur node
+// avoids the banned nodes and edges it is the spur path itself, so no search is needed at all.
+// Spur searches of one iteration are independent and run on worker threads, each with its own
+// workspace kept for the whole query.
+class KShortestPaths {
+private:
+    const Graph& graph;
+    int tree_target = -1;
+    vector<double> tree_dist;   // Distance to the destination
+    vector<int> tree_next;      // Next hop towards the destination, -1 at the destination or if unreachable
+    vector<SearchWorkspace> workspaces;
+    unsigned num_threads;
+    SearchStats last_stats;
+    vector<SearchStats> worker_stats;   // Per worker thread other than the caller's
+
+    struct Candidate {
+        double weight;
+        vector<int> nodes;
+
+        bool operator<(const Candidate& other) const {
+            if (weight != other.weight) return weight < other.weight;
+            return nodes < other.nodes;
+        }
+    };
+
+    template <class Stats>
+    void buildReverseTree(int endNodeId, Stats& counters) {
+        int numNodes = graph.getNumNodes();
+        if (tree_target == endNodeId && static_cast<int>(tree_dist.size()) == numNodes) return;
+
+        tree_target = endNodeId;
+        tree_dist.assign(numNodes, DOUBLE_INF);
+        tree_next.assign(numNodes, -1);
+        SearchWorkspace& ws = workspaces[0];
+        ws.prepare(numNodes);
+        ws.update(endNodeId, 0.0, -1);
+        ws.push(0.0, endNodeId);
+        counters.pushed(ws.heap.size());
+        while (!ws.heap.empty()) {
+            SearchWorkspace::HeapEntry top = ws.pop();
+            counters.popped();
+            int u = top.second;
+            if (ws.isSettled(u)) {
+                counters.stale();
+                continue;
+            }
+            ws.settle(u);
+            counters.settled();
+            tree_dist[u] = top.first;
+            tree_next[u] = ws.previous(u);
+            // Edges are undirected, so u's edges are also the edges entering u
+            for (const Edge& edge : graph.getEdges(u)) {
+                counters.relaxed();
+                double d = top.first + edge.weight;
+                if (d < ws.distance(edge.destination_node_id)) {
+                    ws.update(edge.destination_node_id, d, u);
+                    ws.push(d, edge.destination_node_id);
+                    counters.pushed(ws.heap.size());
+                }
+            }
+        }
+    }
+
+    double edgeWeight(int u, int v) const {
+        double best = DOUBLE_INF;
+        for (const Edge& edge : graph.getEdges(u)) {
+            if (edge.destination_node_id == v) best = min(best, edge.weight);
+        }
+        return best;
+    }
+
+    // Cheapest spur path from spur to the destination avoiding banned nodes (already marked in ws)
+    // and the first hops in banned_next. Returns false if the destination is cut off.
+    template <class Stats>
+    bool spurPath(SearchWorkspace& ws, int spur, const vector<int>& banned_next, vector<int>& out, double& out_weight,
+                  Stats& counters) {
+        out.clear();
+
+        // Reuse the reverse tree when its path is still allowed
+        bool tree_path_ok = tree_next[spur] != -1 &&
+                            find(banned_next.begin(), banned_next.end(), tree_next[spur]) == banned_next.end();
+        for (int v = tree_next[spur]; tree_path_ok && v != -1; v = tree_next[v]) {
+            if (ws.isBanned(v)) tree_path_ok = false;
+        }
+        if (tree_path_ok) {
+            for (int v = spur; v != -1; v = tree_next[v]) out.push_back(v);
+            out_weight = tree_dist[spur];
+            return true;
+        }
+
+        // A* with the exact unrestricted distances as a consistent heuristic
+        ws.prepare(graph.getNumNodes());
+        ws.update(spur, 0.0, -1);
+        ws.push(tree_dist[spur], spur);
+        counters.pushed(ws.heap.size());
+        while (!ws.heap.empty()) {
+            int u = ws.pop().second;
+            counters.popped();
+            if (ws.isSettled(u)) {
+                counters.stale();
+                continue;
+            }
+            ws.settle(u);
+            counters.settled();
+            if (u == tree_target) break;
+            double du = ws.distance(u);
+            for (const Edge& edge : graph.getEdges(u)) {
+                counters.relaxed();
+                int v = edge.destination_node_id;
+                if (ws.isBanned(v) || ws.isSettled(v) || tree_dist[v] == DOUBLE_INF) continue;
+                if (u == spur && find(banned_next.begin(), banned_next.end(), v) != banned_next.end()) continue;
+                double d = du + edge.weight;
+                if (d < ws.distance(v)) {
+                    ws.update(v, d, u);
+                    ws.push(d + tree_dist[v], v);
+                    counters.pushed(ws.heap.size());
+                }
+            }
+        }
+        if (!ws.isSettled(tree_target)) return false;
+
+        out_weight = ws.distance(tree_target);
+        for (int v = tree_target; v != -1; v = ws.previous(v)) out.push_back(v);
+        reverse(out.begin(), out.end());
+        return true;
+    }
+
+    PathDetails toPathDetails(const Candidate& candidate) const {
+        PathDetails result;
+        result.path_exists = true;
+        result.total_weight = candidate.weight;
+        result.node_ids_in_path = candidate.nodes;
+        result.num_stops = static_cast<int>(candidate.nodes.size()) - 1;
+        return result;
+    }
+
+public:
+    KShortestPaths(const Graph& g, unsigned threads = thread::hardware_concurrency()) : graph(g) {
+        num_threads = max(1u, threads);
+        workspaces.resize(num_threads);
+        worker_stats.resize(num_threads);
+    }
+
+    // Up to k loopless routes ranked by total weight, the first being Dijkstra's
+    template <class Stats = NoSearchStats>
+    vector<PathDetails> search(int startNodeId, int endNodeId, int k) {
+        TraceSpan span("k-shortest paths", "search");
+        Stats counters;
+        last_stats = SearchStats();
+        vector<PathDetails> routes;
+        int numNodes = graph.getNumNodes();
+        if (startNodeId >= numNodes || endNodeId >= numNodes || startNodeId < 0 || endNodeId < 0 || k <= 0) {
+            cerr << "Error: Invalid start/end node ID or k in k-shortest paths." << endl;
+            return routes;
+        }
+
+        buildReverseTree(endNodeId, counters);
+        if (tree_dist[startNodeId] == DOUBLE_INF) {
+            counters.finish(last_stats);
+            return routes;
+        }
+        if (Stats::enabled) fill(worker_stats.begin(), worker_stats.end(), SearchStats());
+
+        vector<Candidate> accepted;
+        Candidate shortest;
+        shortest.weight = tree_dist[startNodeId];
+        for (int v = startNodeId; v != -1; v = tree_next[v]) shortest.nodes.push_back(v);
+        accepted.push_back(shortest);
+
+        set<Candidate> candidates;
+        set<vector<int>> seen;
+        seen.insert(shortest.nodes);
+
+        while (static_cast<int>(accepted.size()) < k) {
+            const vector<int>& previous_path = accepted.back().nodes;
+            int spur_count = static_cast<int>(previous_path.size()) - 1;
+
+            vector<double> root_weight(previous_path.size(), 0.0);
+            for (size_t i = 1; i < previous_path.size(); i++) {
+                root_weight[i] = root_weight[i - 1] + edgeWeight(previous_path[i - 1], previous_path[i]);
+            }
+
+            vector<Candidate> found(spur_count);
+            vector<char> found_ok(spur_count, 0);
+            atomic<int> next_spur(0);
+            // The caller's thread counts into counters, every other worker into its own
+            auto worker = [&](unsigned t, Stats& thread_counters) {
+                TraceSpan worker_span("k-shortest spur paths", "search");
+                SearchWorkspace& ws = workspaces[t];
+                ws.prepare(graph.getNumNodes());   // Bans are set before spurPath prepares it
+                vector<int> banned_next;
+                vector<int> spur_nodes;
+                for (int i = next_spur++; i < spur_count; i = next_spur++) {
+                    int spur = previous_path[i];
+
+                    // Accepted paths sharing this root may not leave the spur node the same way
+                    banned_next.clear();
+                    for (const Candidate& path : accepted) {
+                        if (static_cast<int>(path.nodes.size()) > i + 1 &&
+                            equal(previous_path.begin(), previous_path.begin() + i + 1, path.nodes.begin())) {
+                            banned_next.push_back(path.nodes[i + 1]);
+                        }
+                    }
+                    // The root itself may not be revisited
+                    ws.clearBans();
+                    for (int j = 0; j < i; j++) ws.ban(previous_path[j]);
+
+                    double spur_weight;
+                    if (!spurPath(ws, spur, banned_next, spur_nodes, spur_weight, thread_counters)) continue;
+
+                    Candidate& candidate = found[i];
+                    candidate.weight = root_weight[i] + spur_weight;
+                    candidate.nodes.assign(previous_path.begin(), previous_path.begin() + i);
+                    candidate.nodes.insert(candidate.nodes.end(), spur_nodes.begin(), spur_nodes.end());
+                    found_ok[i] = 1;
+                }
+            };
+            unsigned threads = min(num_threads, static_cast<unsigned>(max(1, spur_count)));
+            vector<thread> pool;
+            for (unsigned t = 1; t < threads; t++) {
+                pool.emplace_back([&worker, this, t]() {
+                    Stats thread_counters;
+                    worker(t, thread_counters);
+                    thread_counters.finish(worker_stats[t]);
+                });
+            }
+            try {
+                worker(0, counters);
+            } catch (...) {
+                // The Stats policy may abandon the search (the GUI cancels outdated queries this
+                // way); the other workers still use this frame, so wait for them first
+                for (thread& t : pool) t.join();
+                throw;
+            }
+            for (thread& t : pool) t.join();
+
+            for (int i = 0; i < spur_count; i++) {
+                if (found_ok[i] && seen.insert(found[i].nodes).second) {
+                    candidates.insert(found[i]);
+                }
+            }
+            if (candidates.empty()) break;
+            accepted.push_back(*candidates.begin());
+            candidates.erase(candidates.begin());
+        }
+
+        for (const Candidate& path : accepted) routes.push_back(toPathDetails(path));
+        counters.finish(last_stats);
+        if (Stats::enabled) {
+            for (const SearchStats& part : worker_stats) last_stats.merge(part);
+        }
+        return routes;
+    }
+
+    // Instrumentation of the last search; collected only when it ran with CountSearchStats
+    const SearchStats& lastStats() const { return last_stats; }
+
+    // Call after the graph changes so the reverse tree is rebuilt
+    void invalidate() { tree_target = -1; }
+};
+
+#endif // KSP_H
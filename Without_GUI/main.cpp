@@ -1,220 +1,501 @@
-#include <iostream>
-#include <fstream>   // For file input
-#include <string>
-#include <vector>
-#include <unordered_map>
-#include <limits>    // For numeric_limits
-#include <sstream>   // For robust input for numbers
-#include "graphV1.h"   // Your graph header
-#include "map.h"
-
-using namespace std;
-
-
-// Function to append a new node to the nodes file
-void appendNodeToFile(const Node& node, const string& filename) {
-    ofstream outFile(filename, ios::app); // Open in append mode
-    if (!outFile.is_open()) {
-        cerr << "Error: Could not open nodes file for appending: '" << filename << "'" << endl;
-        return;
-    }
-    outFile << endl << node.id << " " << node.name;
-    outFile.close();
-    cout << "Node '" << node.name << "' appended to " << filename << endl;
-}
-
-// Function to append a new edge to the edges file
-void appendEdgeToFile(int source_id, int dest_id, double weight, const string& filename) {
-    ofstream outFile(filename, ios::app); // Open in append mode
-    if (!outFile.is_open()) {
-        cerr << "Error: Could not open edges file for appending: '" << filename << "'" << endl;
-        return;
-    }
-    outFile << endl << source_id << " " << dest_id << " " << weight;
-    outFile.close();
-    cout << "Edge " << source_id << " " << dest_id << " " << weight << " appended to " << filename << endl;
-}
-
-
-void handleAddData(Graph& graph, const string& nodes_filename, const string& edges_filename) {
-    cout << "\n--- Add New Location/Route ---" << endl;
-    cout << "Do you want to add a (1) New Location or (2) New Route? Enter 1 or 2: ";
-    int choice;
-    while (!(cin >> choice) || (choice != 1 && choice != 2)) {
-        cout << "Invalid input. Please enter 1 or 2: ";
-        clearInputBuffer();
-    }
-    clearInputBuffer(); // Clear buffer after reading choice
-
-    if (choice == 1) { // Add New Location (Node)
-        cout << "Enter the name for the new location: ";
-        string new_location_name;
-        getline(cin, new_location_name);
-
-        if (new_location_name.empty()) {
-            cout << "Location name cannot be empty. Aborting." << endl;
-            return;
-        }
-
-        if (graph.getNodeIndexByname(new_location_name) != -1) {
-            cout << "Location '" << new_location_name << "' already exists. Aborting." << endl;
-            return;
-        }
-
-        int new_node_id = graph.getNumNodes(); // Get the next available ID
-        graph.addNode(new_node_id, new_location_name);
-        cout << "Successfully added new location: " << new_location_name << " with ID: " << new_node_id << endl;
-
-        // Persist the new node to file
-        appendNodeToFile(graph.getNode(new_node_id), nodes_filename);
-
-    } else { // Add New Route (Edge)
-        string source_name, dest_name;
-        double weight;
-
-        cout << "Enter the name of the source location: ";
-        getline(cin, source_name);
-        int source_id = graph.getNodeIndexByname(source_name);
-        if (source_id == -1) {
-            cout << "Source location '" << source_name << "' not found. Aborting." << endl;
-            return;
-        }
-
-        cout << "Enter the name of the destination location: ";
-        getline(cin, dest_name);
-        int dest_id = graph.getNodeIndexByname(dest_name);
-        if (dest_id == -1) {
-            cout << "Destination location '" << dest_name << "' not found. Aborting." << endl;
-            return;
-        }
-
-        // Prevent adding an edge to itself
-        if (source_id == dest_id) {
-            cout << "Cannot add a route from a location to itself. Aborting." << endl;
-            return;
-        }
-
-        cout << "Enter the weight (cost/time) of the route between " << source_name << " and " << dest_name << ": ";
-        while (!(cin >> weight) || weight < 0) {
-            cout << "Invalid weight. Please enter a non-negative number: ";
-            clearInputBuffer();
-        }
-        clearInputBuffer();
-
-        // Add the edge (assuming undirected, as in your graph setup)
-        graph.addEdge(source_id, dest_id, weight);
-        cout << "Successfully added route between " << source_name << " and " << dest_name << " with weight " << weight << endl;
-        // Persist the new edge(s) to file
-        appendEdgeToFile(source_id, dest_id, weight, edges_filename);
-
-    }
-    cout << "----------------------------\n" << endl;
-}
-
-
-
-void displayPathDetails(const PathDetails& path, Graph* graph) {
-    cout << "\n--- Route Details ---" << endl;
-    if (!path.path_exists) {
-        cout << "No path found." << endl;
-        return;
-    }
-
-    cout << "Path: ";
-    bool is_first_node = true;
-    for (int current_node_id : path.node_ids_in_path) { // Range-based for loop
-        if (!is_first_node) {
-            cout << " -> "; // Print separator before the element (but not for the first one)
-        }
-        cout << graph->getNode(current_node_id).name;
-        is_first_node = false; // After processing the first node, set flag to false
-    }
-    cout << endl;
-
-    if (path.num_stops != -1) {
-        cout << "Number of stops (segments): " << path.num_stops << endl;
-    }
-    if (path.total_weight != DOUBLE_INF) {
-        cout << "Total cost (time/distance): " << path.total_weight << endl;
-    }
-    cout << "---------------------\n" << endl;
-}
-
-int main() {
-    Graph bus_network;
-
-
-    cout << "Enter the filename for nodes (e.g., nodes.txt): ";
-    string nodes_filename;
-    cin >> nodes_filename;
-
-    cout << "Enter the filename for edges (e.g., edges.txt): ";
-    string edges_filename;
-    cin >> edges_filename;
-
-    // Assign files to map using the new constructor
-    Map map1(nodes_filename, edges_filename);
-
-    // Load map to graph
-    if (!map1.map_to_graph(bus_network)) {
-        cerr << "Failed to load map. Exiting." << endl;
-        return 1; // Indicate an error
-    }
-
-    while (true) {
-        cout << "\nUniversity Commute Optimizer Menu:" << endl;
-        // University is now always ID 0, and its name is obtained from the Map object
-        cout << "Destination is fixed to: " << map1.getUniversityName() << " (ID: 0)" << endl;
-
-        cout << "1. Find Fastest Route (Dijkstra)" << endl;
-        cout << "2. Find Route with Minimum Stops (BFS)" << endl;
-        cout << "3. Add new location/route to map" << endl; // New Option
-        cout << "4. Print Current Graph Map" << endl;       // New utility option
-        cout << "5. Exit" << endl;
-        cout << "Enter your choice: ";
-
-        int main_choice;
-        while (!(cin >> main_choice) || main_choice < 1 || main_choice > 5  ) {
-            cout << "Invalid input. Please enter a positive number: ";
-            clearInputBuffer();
-        }
-
-        string start_stop;
-        // The university's ID is now always 0
-        const int UNIVERSITY_NODE_ID = 0;
-
-        switch (main_choice) {
-            case 1: // Find Fastest Route
-                cout << "Enter your starting location name (e.g., Home, CentralStation): ";
-                cin >> start_stop;
-                if (bus_network.getNodeIndexByname(start_stop) != -1) {
-                    displayPathDetails(bus_network.Dijkstra(bus_network.getNodeIndexByname(start_stop), UNIVERSITY_NODE_ID), &bus_network);
-                } else {
-                    cout << "Starting location '" << start_stop << "' not found in the map." << endl;
-                }
-                break;
-            case 2: // Find Route with Minimum Stops
-                cout << "Enter your starting location name (e.g., Home, CentralStation): ";
-                cin >> start_stop;
-                cout << "\nFinding route with minimum stops from " << start_stop << " to " << map1.getUniversityName() << "..." << endl;
-                if (bus_network.getNodeIndexByname(start_stop) != -1) {
-                    displayPathDetails(bus_network.BFS(bus_network.getNodeIndexByname(start_stop), UNIVERSITY_NODE_ID), &bus_network);
-                } else {
-                    cout << "Starting location '" << start_stop << "' not found in the map." << endl;
-                }
-                break;
-            case 3:
-                handleAddData(bus_network, nodes_filename, edges_filename);
-                break;
-            case 4: // Print Graph
-                bus_network.printAdjacencyMatrix();
-                break;
-            case 5: // Exit
-                cout << "Exiting program. Safe travels!" << endl;
-                return 0;
-            default:
-                cout << "Invalid choice. Please try again." << endl;
-                break;
-        }
-    }
-}
+#include <iostream>
+#include <fstream>   // For file input
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <limits>    // For numeric_limits
+#include <sstream>   // For robust input for numbers
+#include <cmath>
+#include "graphV1.h"   // Your graph header
+#include "map.h"
+#include "timetable.h"
+#include "raptor.h"
+#include "pareto.h"
+#include "ksp.h"
+#include "alternatives.h"
+#include "isochrone.h"
+#include "fuzzy_match.h"
+#include "query_log.h"
+
+using namespace std;
+
+// Spelling fallback for stop names that are not found exactly
+FuzzyNameMatcher stop_matcher;
+
+// Every menu search, when COMMUTE_QUERY_LOG names a file; replay it with commute_replay
+QueryLog query_log;
+
+// Instrumentation for menu searches, hardware counters included where the machine has them;
+// NoSearchStats compiles it out
+typedef PerfSearchStats MenuSearchStats;
+
+void displaySearchStats(const SearchStats& stats) {
+    if (stats.collected) {
+        cout << "Search: " << stats.summary() << endl;
+    }
+}
+
+// Look a stop up by name. If there is no exact match, a clearly closest spelling is used when
+// allow_guess is set; otherwise the nearest names are suggested and -1 is returned.
+int findStop(const Graph& graph, const string& typed, const string& role, bool allow_guess) {
+    int id = graph.getNodeIndexByname(typed);
+    if (id != -1) {
+        return id;
+    }
+    vector<FuzzyMatch> matches = stop_matcher.search(graph, typed);
+    if (allow_guess && FuzzyNameMatcher::clearlyBest(matches)) {
+        cout << role << " '" << typed << "' not found; using closest match '" << graph.getNodeName(matches[0].node_id) << "'." << endl;
+        return matches[0].node_id;
+    }
+    cout << role << " '" << typed << "' not found in the map.";
+    if (!matches.empty()) {
+        cout << " Did you mean:";
+        for (size_t i = 0; i < matches.size(); i++) {
+            cout << (i == 0 ? " " : ", ") << graph.getNodeName(matches[i].node_id);
+        }
+        cout << "?";
+    }
+    cout << endl;
+    return -1;
+}
+
+
+// Function to append a new node to the nodes file
+void appendNodeToFile(int node_id, string_view node_name, const string& filename) {
+    TraceSpan span("append node to file", "edit");
+    ofstream outFile(filename, ios::app); // Open in append mode
+    if (!outFile.is_open()) {
+        cerr << "Error: Could not open nodes file for appending: '" << filename << "'" << endl;
+        return;
+    }
+    outFile << endl << node_id << " " << node_name;
+    outFile.close();
+    cout << "Node '" << node_name << "' appended to " << filename << endl;
+}
+
+// Function to append a new edge to the edges file
+void appendEdgeToFile(int source_id, int dest_id, double weight, const string& filename) {
+    TraceSpan span("append edge to file", "edit");
+    ofstream outFile(filename, ios::app); // Open in append mode
+    if (!outFile.is_open()) {
+        cerr << "Error: Could not open edges file for appending: '" << filename << "'" << endl;
+        return;
+    }
+    outFile << endl << source_id << " " << dest_id << " " << weight;
+    outFile.close();
+    cout << "Edge " << source_id << " " << dest_id << " " << weight << " appended to " << filename << endl;
+}
+
+
+void handleAddData(Graph& graph, const string& nodes_filename, const string& edges_filename) {
+    cout << "\n--- Add New Location/Route ---" << endl;
+    cout << "Do you want to add a (1) New Location or (2) New Route? Enter 1 or 2: ";
+    int choice;
+    while (!(cin >> choice) || (choice != 1 && choice != 2)) {
+        cout << "Invalid input. Please enter 1 or 2: ";
+        clearInputBuffer();
+    }
+    clearInputBuffer(); // Clear buffer after reading choice
+
+    if (choice == 1) { // Add New Location (Node)
+        cout << "Enter the name for the new location: ";
+        string new_location_name;
+        getline(cin, new_location_name);
+
+        if (new_location_name.empty()) {
+            cout << "Location name cannot be empty. Aborting." << endl;
+            return;
+        }
+
+        if (graph.getNodeIndexByname(new_location_name) != -1) {
+            cout << "Location '" << new_location_name << "' already exists. Aborting." << endl;
+            return;
+        }
+
+        int new_node_id = graph.getNumNodes(); // Get the next available ID
+        graph.addNode(new_node_id, new_location_name);
+        cout << "Successfully added new location: " << new_location_name << " with ID: " << new_node_id << endl;
+
+        // Persist the new node to file
+        if (Map::detectFormat(nodes_filename) == MAP_FORMAT_SINGLE_FILE) {
+            if (Map::save_single_file(graph, nodes_filename)) {
+                cout << "Node '" << new_location_name << "' saved to " << nodes_filename << endl;
+            }
+        } else {
+            appendNodeToFile(new_node_id, graph.getNodeName(new_node_id), nodes_filename);
+        }
+
+    } else { // Add New Route (Edge)
+        string source_name, dest_name;
+        double weight;
+
+        cout << "Enter the name of the source location: ";
+        getline(cin, source_name);
+        int source_id = findStop(graph, source_name, "Source location", false);
+        if (source_id == -1) {
+            cout << "Aborting." << endl;
+            return;
+        }
+
+        cout << "Enter the name of the destination location: ";
+        getline(cin, dest_name);
+        int dest_id = findStop(graph, dest_name, "Destination location", false);
+        if (dest_id == -1) {
+            cout << "Aborting." << endl;
+            return;
+        }
+
+        // Prevent adding an edge to itself
+        if (source_id == dest_id) {
+            cout << "Cannot add a route from a location to itself. Aborting." << endl;
+            return;
+        }
+
+        cout << "Enter the weight (cost/time) of the route between " << source_name << " and " << dest_name << ": ";
+        while (!(cin >> weight) || weight < 0) {
+            cout << "Invalid weight. Please enter a non-negative number: ";
+            clearInputBuffer();
+        }
+        clearInputBuffer();
+
+        // Add the edge (assuming undirected, as in your graph setup)
+        graph.addEdge(source_id, dest_id, weight);
+        cout << "Successfully added route between " << source_name << " and " << dest_name << " with weight " << weight << endl;
+        // Persist the new edge(s) to file
+        if (Map::detectFormat(nodes_filename) == MAP_FORMAT_SINGLE_FILE) {
+            if (Map::save_single_file(graph, nodes_filename)) {
+                cout << "Edge " << source_id << " " << dest_id << " " << weight << " saved to " << nodes_filename << endl;
+            }
+        } else {
+            appendEdgeToFile(source_id, dest_id, weight, edges_filename);
+        }
+
+    }
+    cout << "----------------------------\n" << endl;
+}
+
+
+
+void displayPathDetails(const PathDetails& path, Graph* graph) {
+    cout << "\n--- Route Details ---" << endl;
+    if (!path.path_exists) {
+        cout << "No path found." << endl;
+        return;
+    }
+
+    cout << "Path: ";
+    bool is_first_node = true;
+    for (int current_node_id : path.node_ids_in_path) { // Range-based for loop
+        if (!is_first_node) {
+            cout << " -> "; // Print separator before the element (but not for the first one)
+        }
+        cout << graph->getNodeName(current_node_id);
+        is_first_node = false; // After processing the first node, set flag to false
+    }
+    cout << endl;
+
+    if (path.num_stops != -1) {
+        cout << "Number of stops (segments): " << path.num_stops << endl;
+    }
+    if (path.total_weight != DOUBLE_INF) {
+        cout << "Total cost (time/distance): " << path.total_weight << endl;
+    }
+    displaySearchStats(path.stats);
+    cout << "---------------------\n" << endl;
+}
+
+void displayJourney(const Journey& journey, const Timetable& timetable, Graph* graph) {
+    cout << "\n--- Journey Details ---" << endl;
+    if (!journey.journey_exists) {
+        cout << "No journey found." << endl;
+        return;
+    }
+
+    for (const JourneyLeg& leg : journey.legs) {
+        if (leg.route_id == -1) {
+            cout << "Walk  " << formatClockTime(leg.board_time) << " " << graph->getNodeName(leg.board_stop_id)
+                 << " -> " << formatClockTime(leg.alight_time) << " " << graph->getNodeName(leg.alight_stop_id) << endl;
+        } else {
+            cout << timetable.route_names[leg.route_id] << "  " << formatClockTime(leg.board_time) << " "
+                 << graph->getNodeName(leg.board_stop_id) << " -> " << formatClockTime(leg.alight_time) << " "
+                 << graph->getNodeName(leg.alight_stop_id) << endl;
+        }
+    }
+    cout << "Leave at: " << formatClockTime(journey.departure_time)
+         << ", arrive at: " << formatClockTime(journey.arrival_time) << endl;
+    cout << "Number of transfers: " << journey.num_transfers << endl;
+    displaySearchStats(journey.stats);
+    cout << "-----------------------\n" << endl;
+}
+
+void handleTimetableQuery(Graph& graph, Timetable& timetable, int university_id) {
+    if (!timetable.isLoaded()) {
+        cout << "Enter the filename for the timetable (e.g., timetable.txt): ";
+        string timetable_filename;
+        cin >> timetable_filename;
+        if (!timetable.load(timetable_filename, graph)) {
+            cout << "Failed to load timetable." << endl;
+            return;
+        }
+    }
+
+    cout << "Enter your starting location name (e.g., Home, CentralStation): ";
+    string start_stop;
+    cin >> start_stop;
+    int start_id = findStop(graph, start_stop, "Starting location", true);
+    if (start_id == -1) {
+        return;
+    }
+    if (start_id >= timetable.numStops) {
+        cout << "Location '" << start_stop << "' was added after the timetable was loaded." << endl;
+        return;
+    }
+
+    cout << "Enter the departure time (HH:MM) or a departure window (HH:MM-HH:MM): ";
+    string when;
+    cin >> when;
+    size_t dash = when.find('-');
+    int window_start = parseClockTime(when.substr(0, dash));
+    int window_end = dash == string::npos ? window_start : parseClockTime(when.substr(dash + 1));
+    if (window_start < 0 || window_end < window_start) {
+        cout << "Invalid time '" << when << "'." << endl;
+        return;
+    }
+
+    cout << "Enter the maximum number of transfers: ";
+    int max_transfers;
+    while (!(cin >> max_transfers) || max_transfers < 0) {
+        cout << "Invalid input. Please enter a non-negative number: ";
+        clearInputBuffer();
+    }
+
+    if (dash == string::npos) {
+        query_log.record(QUERY_RAPTOR, start_id, university_id, window_start, max_transfers);
+        RaptorEngine engine(timetable);
+        displayJourney(engine.earliestArrival<MenuSearchStats>(start_id, university_id, window_start, max_transfers), timetable, &graph);
+        return;
+    }
+
+    query_log.record(QUERY_RAPTOR_RANGE, start_id, university_id, window_start, window_end, max_transfers);
+    vector<Journey> profile = raptorRangeQuery<MenuSearchStats>(timetable, start_id, university_id, window_start, window_end, max_transfers);
+    if (profile.empty()) {
+        cout << "\nNo journey departs in that window." << endl;
+    }
+    for (const Journey& journey : profile) {
+        displayJourney(journey, timetable, &graph);
+    }
+}
+
+void displayIsochrone(const IsochroneResult& isochrone, Graph* graph) {
+    cout << "\n--- Reachable Stops ---" << endl;
+    int shown = 0;
+    for (size_t band = 0; band < isochrone.thresholds.size(); band++) {
+        cout << "Within " << isochrone.thresholds[band] << ": " << isochrone.counts[band] << " stops" << endl;
+        for (; shown < isochrone.counts[band]; shown++) {
+            cout << "  " << graph->getNodeName(isochrone.node_ids[shown]) << " (" << isochrone.distances[shown] << ")" << endl;
+        }
+    }
+    displaySearchStats(isochrone.stats);
+    cout << "-----------------------\n" << endl;
+}
+
+// Set COMMUTE_TRACE=trace.json to record load and search spans (trace.h); the file is written
+// on exit and opens in chrome://tracing or ui.perfetto.dev. Set COMMUTE_QUERY_LOG=queries.bin to
+// log every search for commute_replay (query_log.h).
+int main() {
+    Graph bus_network;
+    Timetable timetable;
+    Tracer::startFromEnvironment();
+    query_log.openFromEnvironment();
+
+
+    cout << "Enter the filename for nodes (e.g., nodes.txt or Summer_Routes.txt): ";
+    string nodes_filename;
+    cin >> nodes_filename;
+
+    // Single-file maps such as Summer_Routes.txt already contain the edges
+    string edges_filename;
+    if (Map::detectFormat(nodes_filename) != MAP_FORMAT_SINGLE_FILE) {
+        cout << "Enter the filename for edges (e.g., edges.txt): ";
+        cin >> edges_filename;
+    }
+
+    // Assign files to map using the new constructor
+    Map map1(nodes_filename, edges_filename);
+
+    // Load map to graph
+    if (!map1.map_to_graph(bus_network)) {
+        cerr << "Failed to load map. Exiting." << endl;
+        Tracer::finish();
+        return 1; // Indicate an error
+    }
+    if (!PerfCounters::forThisThread().available()) {
+        cout << "Note: Search statistics will not include hardware counters: "
+             << PerfCounters::forThisThread().unavailableReason() << "." << endl;
+    }
+
+    while (true) {
+        cout << "\nUniversity Commute Optimizer Menu:" << endl;
+        // University is now always ID 0, and its name is obtained from the Map object
+        cout << "Destination is fixed to: " << map1.getUniversityName() << " (ID: 0)" << endl;
+
+        cout << "1. Find Fastest Route (Dijkstra)" << endl;
+        cout << "2. Find Route with Minimum Stops (BFS)" << endl;
+        cout << "3. Add new location/route to map" << endl; // New Option
+        cout << "4. Print Current Graph Map" << endl;       // New utility option
+        cout << "5. Plan with Bus Timetable (RAPTOR)" << endl;
+        cout << "6. Compare Travel Time vs Stops (Pareto)" << endl;
+        cout << "7. Find Backup Routes (K Shortest Paths)" << endl;
+        cout << "8. Find Alternative Routes (Different Roads)" << endl;
+        cout << "9. Stops Within Travel Time of University" << endl;
+        cout << "10. Exit" << endl;
+        cout << "Enter your choice: ";
+
+        int main_choice;
+        while (!(cin >> main_choice) || main_choice < 1 || main_choice > 10  ) {
+            cout << "Invalid input. Please enter a positive number: ";
+            clearInputBuffer();
+        }
+
+        string start_stop;
+        // The university's ID is now always 0
+        const int UNIVERSITY_NODE_ID = 0;
+
+        switch (main_choice) {
+            case 1: { // Find Fastest Route
+                cout << "Enter your starting location name (e.g., Home, CentralStation): ";
+                cin >> start_stop;
+                int start_id = findStop(bus_network, start_stop, "Starting location", true);
+                if (start_id != -1) {
+                    query_log.record(QUERY_DIJKSTRA, start_id, UNIVERSITY_NODE_ID);
+                    displayPathDetails(bus_network.Dijkstra<MenuSearchStats>(start_id, UNIVERSITY_NODE_ID), &bus_network);
+                }
+                break;
+            }
+            case 2: { // Find Route with Minimum Stops
+                cout << "Enter your starting location name (e.g., Home, CentralStation): ";
+                cin >> start_stop;
+                cout << "\nFinding route with minimum stops from " << start_stop << " to " << map1.getUniversityName() << "..." << endl;
+                int start_id = findStop(bus_network, start_stop, "Starting location", true);
+                if (start_id != -1) {
+                    query_log.record(QUERY_BFS, start_id, UNIVERSITY_NODE_ID);
+                    displayPathDetails(bus_network.BFS<MenuSearchStats>(start_id, UNIVERSITY_NODE_ID), &bus_network);
+                }
+                break;
+            }
+            case 3:
+                handleAddData(bus_network, nodes_filename, edges_filename);
+                break;
+            case 4: // Print Graph
+                bus_network.printAdjacencyMatrix();
+                break;
+            case 5: // Timetable routing
+                handleTimetableQuery(bus_network, timetable, UNIVERSITY_NODE_ID);
+                break;
+            case 6: { // Every non-dominated trade-off in one search
+                cout << "Enter your starting location name (e.g., Home, CentralStation): ";
+                cin >> start_stop;
+                int start_id = findStop(bus_network, start_stop, "Starting location", true);
+                if (start_id == -1) {
+                    break;
+                }
+                query_log.record(QUERY_PARETO, start_id, UNIVERSITY_NODE_ID);
+                ParetoSearch pareto(bus_network);
+                vector<PathDetails> options = pareto.search<MenuSearchStats>(start_id, UNIVERSITY_NODE_ID);
+                if (options.empty()) {
+                    displayPathDetails(PathDetails(), &bus_network);
+                }
+                for (size_t i = 0; i < options.size(); i++) {
+                    cout << "\nOption " << i + 1 << " of " << options.size() << ":";
+                    displayPathDetails(options[i], &bus_network);
+                }
+                displaySearchStats(pareto.lastStats());
+                break;
+            }
+            case 7: { // Ranked backup routes
+                cout << "Enter your starting location name (e.g., Home, CentralStation): ";
+                cin >> start_stop;
+                int start_id = findStop(bus_network, start_stop, "Starting location", true);
+                if (start_id == -1) {
+                    break;
+                }
+                cout << "How many routes do you want? ";
+                int k;
+                while (!(cin >> k) || k < 1) {
+                    cout << "Invalid input. Please enter a positive number: ";
+                    clearInputBuffer();
+                }
+                query_log.record(QUERY_KSP, start_id, UNIVERSITY_NODE_ID, k);
+                KShortestPaths ksp(bus_network);
+                vector<PathDetails> routes = ksp.search<MenuSearchStats>(start_id, UNIVERSITY_NODE_ID, k);
+                if (routes.empty()) {
+                    displayPathDetails(PathDetails(), &bus_network);
+                }
+                for (size_t i = 0; i < routes.size(); i++) {
+                    cout << "\nRoute " << i + 1 << " of " << routes.size() << ":";
+                    displayPathDetails(routes[i], &bus_network);
+                }
+                displaySearchStats(ksp.lastStats());
+                break;
+            }
+            case 8: { // Routes sharing little with the fastest one
+                cout << "Enter your starting location name (e.g., Home, CentralStation): ";
+                cin >> start_stop;
+                int start_id = findStop(bus_network, start_stop, "Starting location", true);
+                if (start_id == -1) {
+                    break;
+                }
+                cout << "Method: (1) Plateaus or (2) Penalties? Enter 1 or 2: ";
+                int method;
+                while (!(cin >> method) || (method != 1 && method != 2)) {
+                    cout << "Invalid input. Please enter 1 or 2: ";
+                    clearInputBuffer();
+                }
+                AlternativeMethod chosen = method == 1 ? ALTERNATIVES_PLATEAU : ALTERNATIVES_PENALTY;
+                query_log.record(QUERY_ALTERNATIVES, start_id, UNIVERSITY_NODE_ID, chosen);
+                AlternativeRoutes alternatives(bus_network);
+                vector<PathDetails> routes = alternatives.search<MenuSearchStats>(start_id, UNIVERSITY_NODE_ID, chosen);
+                if (routes.empty()) {
+                    displayPathDetails(PathDetails(), &bus_network);
+                } else if (routes.size() == 1) {
+                    cout << "\nNo sufficiently different alternative exists; the fastest route is:";
+                }
+                for (size_t i = 0; i < routes.size(); i++) {
+                    if (routes.size() > 1) {
+                        cout << "\n" << (i == 0 ? string("Fastest route") : "Alternative " + to_string(i)) << ":";
+                    }
+                    displayPathDetails(routes[i], &bus_network);
+                }
+                displaySearchStats(alternatives.lastStats());
+                break;
+            }
+            case 9: { // Isochrones around the university
+                cout << "Enter one or more time limits on one line (e.g., 30 45 60): ";
+                clearInputBuffer();
+                string line;
+                getline(cin, line);
+                istringstream limits(line);
+                vector<double> thresholds;
+                double limit;
+                while (limits >> limit) {
+                    if (limit >= 0) thresholds.push_back(limit);
+                }
+                if (thresholds.empty()) {
+                    cout << "No valid time limit entered." << endl;
+                    break;
+                }
+                query_log.recordIsochrone(UNIVERSITY_NODE_ID, thresholds);
+                IsochroneSearch isochrone(bus_network);
+                displayIsochrone(isochrone.search<MenuSearchStats>(UNIVERSITY_NODE_ID, thresholds), &bus_network);
+                break;
+            }
+            case 10: // Exit
+                cout << "Exiting program. Safe travels!" << endl;
+                Tracer::finish();
+                return 0;
+            default:
+                cout << "Invalid choice. Please try again." << endl;
+                break;
+        }
+    }
+}
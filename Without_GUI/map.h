@@ -1,104 +1,247 @@
-#ifndef MAP_H
-#define MAP_H
-#include <fstream>   // For file input
-#include <sstream>   // For robust input for numbers
-#include <string>
-#include <limits>
-#include "graphV1.h"
-
-using namespace std;
-
-
-class Map {
-private:
-    string nodes_filename;
-    string edges_filename;
-    string university_name;
-
-public:
-    Map(string const& nodes_name, string const& edges_name) {
-        nodes_filename = nodes_name;
-        edges_filename = edges_name;
-    }
-
-    bool map_to_graph(Graph& graph) {
-        // --- 1. Load Nodes ---
-        ifstream nodesFile(nodes_filename);
-        if (!nodesFile.is_open()) {
-            cerr << "Error: Could not open nodes file '" << nodes_filename << "'" << endl;
-            return false;
-        }
-
-        int id;
-        string name;
-        int max_node_id = -1; // To determine the total number of nodes for graph resizing
-
-        // Read nodes in a simpler way: assuming ID and Name are space-separated, single words
-        while (nodesFile >> id >> name) { // Simpler read using operator>>
-            if (id < 0 || name.empty()) {
-                cerr << "Error: Invalid node definition (ID or name empty) in nodes file. Line: '" << id << " " << name << "'" << endl;
-                nodesFile.close();
-                return false;
-            }
-
-            // If this is the university (ID 0), store its name
-            if (id == 0) {
-                university_name = name;
-            }
-
-            graph.addNode(id, name); // Add node to graph
-            if (id > max_node_id) {
-                max_node_id = id;
-            }
-        }
-        nodesFile.close();
-
-        // After reading all nodes, ensure graph has enough space.
-        // The graph's numNodes will be max_node_id + 1
-        graph.numNodes = max_node_id + 1; // Explicitly set numNodes
-        graph.nodes_list.resize(graph.numNodes); // Resize nodes_list if necessary
-
-        // This loop ensures any default-constructed nodes due to resize are given correct IDs
-        // in case addNode didn't handle it precisely or for sparse IDs (not the case here)
-        for (int i = 0; i <= max_node_id; ++i) {
-            if (graph.nodes_list[i].id == -1) { // If it's a default-constructed node without ID set
-                graph.nodes_list[i].id = i;
-            }
-        }
-
-        // --- 2. Load Edges ---
-        ifstream edgesFile(edges_filename);
-        if (!edgesFile.is_open()) {
-            cerr << "Error: Could not open edges file '" << edges_filename << "'" << endl;
-            return false;
-        }
-
-        int source_id, dest_id;
-        double weight;
-        while (edgesFile >> source_id >> dest_id >> weight) {
-            if (source_id < 0 || source_id >= graph.getNumNodes() ||
-                dest_id < 0 || dest_id >= graph.getNumNodes() || weight < 0) {
-                cerr << "Error: Invalid edge definition in edges file (ID out of range or invalid weight): "
-                     << source_id << " " << dest_id << " " << weight << endl;
-                edgesFile.close();
-                return false;
-            }
-            graph.addEdge(source_id, dest_id, weight);
-        }
-        edgesFile.close();
-
-        cout << "Successfully loaded map from '" << nodes_filename << "' and '" << edges_filename << "'." << endl;
-        cout << "University stop set to: " << university_name << " (ID: 0)" << endl;
-        return true;
-    }
-
-    void setNodesFilename(string const &name) { nodes_filename = name; }
-    void setEdgesFilename(string const &name) { edges_filename = name; }
-    string getNodesFilename() { return nodes_filename; }
-    string getEdgesFilename() { return edges_filename; }
-    string getUniversityName() { return university_name; }
-
-    ~Map() {};
-};
-
-#endif // MAP_H
+#ifndef MAP_H
+#define MAP_H
+#include <fstream>   // For file input
+#include <sstream>   // For robust input for numbers
+#include <string>
+#include <limits>
+#include <cstdio>    // For rename() and remove()
+#include "graphV1.h"
+
+using namespace std;
+
+// On-disk map layouts understood by Map::map_to_graph
+enum MapFormat {
+    MAP_FORMAT_UNKNOWN,
+    MAP_FORMAT_SPLIT_FILES,  // nodes.txt ("id name" lines) + edges.txt ("source dest weight" lines)
+    MAP_FORMAT_SINGLE_FILE   // Summer_Routes.txt: node count, nodes, unnumbered university line, edges
+};
+
+class Map {
+private:
+    string nodes_filename;
+    string edges_filename;
+    string university_name;
+
+public:
+    Map(string const& nodes_name, string const& edges_name) {
+        nodes_filename = nodes_name;
+        edges_filename = edges_name;
+    }
+
+    // Single-file map such as Summer_Routes.txt
+    Map(string const& map_name) {
+        nodes_filename = map_name;
+    }
+
+    // Decide the layout from the first line: a lone count means the single-file format
+    static MapFormat detectFormat(string const& filename) {
+        ifstream file(filename);
+        if (!file.is_open()) {
+            return MAP_FORMAT_UNKNOWN;
+        }
+        string line;
+        while (getline(file, line)) {
+            istringstream iss(line);
+            string first, second;
+            if (!(iss >> first)) continue; // Skip blank lines
+            if (first.find_first_not_of("0123456789") != string::npos) return MAP_FORMAT_UNKNOWN;
+            return (iss >> second) ? MAP_FORMAT_SPLIT_FILES : MAP_FORMAT_SINGLE_FILE;
+        }
+        return MAP_FORMAT_UNKNOWN;
+    }
+
+    bool isSingleFile() { return detectFormat(nodes_filename) == MAP_FORMAT_SINGLE_FILE; }
+
+    bool map_to_graph(Graph& graph) {
+        TraceSpan span("map_to_graph", "load");
+        if (isSingleFile()) {
+            return single_file_to_graph(graph);
+        }
+
+
+        // --- 1. Load Nodes ---
+        ifstream nodesFile(nodes_filename);
+        if (!nodesFile.is_open()) {
+            cerr << "Error: Could not open nodes file '" << nodes_filename << "'" << endl;
+            return false;
+        }
+
+        int id;
+        string name;
+        int max_node_id = -1; // To determine the total number of nodes for graph resizing
+
+        // Read nodes in a simpler way: assuming ID and Name are space-separated, single words
+        {
+            TraceSpan nodes_span("read nodes file", "load");
+            while (nodesFile >> id >> name) { // Simpler read using operator>>
+                if (id < 0 || name.empty()) {
+                    cerr << "Error: Invalid node definition (ID or name empty) in nodes file. Line: '" << id << " " << name << "'" << endl;
+                    nodesFile.close();
+                    return false;
+                }
+
+                // If this is the university (ID 0), store its name
+                if (id == 0) {
+                    university_name = name;
+                }
+
+                graph.addNode(id, name); // Add node to graph
+                if (id > max_node_id) {
+                    max_node_id = id;
+                }
+            }
+        }
+        nodesFile.close();
+
+        // After reading all nodes, ensure graph has enough space.
+        // The graph's numNodes will be max_node_id + 1; nodes skipped in the file get their index as ID
+        graph.resizeNodes(max_node_id + 1);
+
+        // --- 2. Load Edges ---
+        ifstream edgesFile(edges_filename);
+        if (!edgesFile.is_open()) {
+            cerr << "Error: Could not open edges file '" << edges_filename << "'" << endl;
+            return false;
+        }
+
+        int source_id, dest_id;
+        double weight;
+        {
+            TraceSpan edges_span("read edges file", "load");
+            while (edgesFile >> source_id >> dest_id >> weight) {
+                if (source_id < 0 || source_id >= graph.getNumNodes() ||
+                    dest_id < 0 || dest_id >= graph.getNumNodes() || weight < 0) {
+                    cerr << "Error: Invalid edge definition in edges file (ID out of range or invalid weight): "
+                         << source_id << " " << dest_id << " " << weight << endl;
+                    edgesFile.close();
+                    return false;
+                }
+                graph.addEdge(source_id, dest_id, weight);
+            }
+        }
+        edgesFile.close();
+        graph.compactEdges(); // Pack each stop's edges in stop order for the searches
+
+        cout << "Successfully loaded map from '" << nodes_filename << "' and '" << edges_filename << "'." << endl;
+        cout << "University stop set to: " << university_name << " (ID: 0)" << endl;
+        return true;
+    }
+
+    // Load the single-file format in one streaming pass.
+    // The file numbers regular stops 0..count-1 and gives the university no number (edges refer to
+    // it as count), while the graph keeps the university at ID 0, so file ID i becomes i + 1.
+    bool single_file_to_graph(Graph& graph) {
+        ifstream mapFile(nodes_filename);
+        if (!mapFile.is_open()) {
+            cerr << "Error: Could not open map file '" << nodes_filename << "'" << endl;
+            return false;
+        }
+
+        int node_count;
+        if (!(mapFile >> node_count) || node_count < 0) {
+            cerr << "Error: Map file '" << nodes_filename << "' must start with the number of stops." << endl;
+            return false;
+        }
+
+        // The header tells us the final size, so the node list is allocated once
+        graph.clearNodes();
+        graph.name_index.clear();
+        graph.names = NameArena();
+        graph.names.reserve(node_count + 1, (node_count + 1) * 16); // Typical names are under 16 characters
+        graph.resizeNodes(node_count + 1);
+
+        int id;
+        string name;
+        {
+            TraceSpan nodes_span("read stops", "load");
+            for (int i = 0; i < node_count; ++i) {
+                if (!(mapFile >> id >> name) || id < 0 || id >= node_count) {
+                    cerr << "Error: Invalid node definition " << i << " in map file '" << nodes_filename << "'" << endl;
+                    return false;
+                }
+                graph.setNodeName(id + 1, name);
+            }
+        }
+
+        if (!(mapFile >> university_name)) {
+            cerr << "Error: Missing university line in map file '" << nodes_filename << "'" << endl;
+            return false;
+        }
+        graph.setNodeName(0, university_name);
+        graph.rebuildNameIndex();
+
+        auto to_graph_id = [node_count](int file_id) { return file_id == node_count ? 0 : file_id + 1; };
+
+        int source_id, dest_id;
+        double weight;
+        {
+            TraceSpan edges_span("read roads", "load");
+            while (mapFile >> source_id >> dest_id >> weight) {
+                if (source_id < 0 || source_id > node_count || dest_id < 0 || dest_id > node_count || weight < 0) {
+                    cerr << "Error: Invalid edge definition in map file (ID out of range or invalid weight): "
+                         << source_id << " " << dest_id << " " << weight << endl;
+                    return false;
+                }
+                graph.addEdge(to_graph_id(source_id), to_graph_id(dest_id), weight);
+            }
+        }
+        mapFile.close();
+        graph.compactEdges(); // Pack each stop's edges in stop order for the searches
+
+        cout << "Successfully loaded map from '" << nodes_filename << "'." << endl;
+        cout << "University stop set to: " << university_name << " (ID: 0)" << endl;
+        return true;
+    }
+
+    // Rewrite a whole single-file map from the graph. The format has a count header and the
+    // university line between nodes and edges, so new data cannot simply be appended. The map is
+    // written to a temporary file that replaces the original only once it is complete, so a failed
+    // write never leaves the user's map truncated.
+    static bool save_single_file(const Graph& graph, string const& filename) {
+        string temp_filename = filename + ".tmp";
+        ofstream outFile(temp_filename);
+        if (!outFile.is_open()) {
+            cerr << "Error: Could not open map file for writing: '" << temp_filename << "'" << endl;
+            return false;
+        }
+
+        int node_count = graph.getNumNodes() - 1;
+        auto to_file_id = [node_count](int graph_id) { return graph_id == 0 ? node_count : graph_id - 1; };
+
+        outFile << node_count;
+        for (int i = 1; i <= node_count; ++i) {
+            outFile << endl << i - 1 << " " << graph.getNodeName(i);
+        }
+        outFile << endl << graph.getNodeName(0);
+        for (int i = 0; i <= node_count; ++i) {
+            for (const Edge& edge : graph.getEdges(i)) {
+                // Each undirected edge is stored on both endpoints; write it once
+                if (i < edge.destination_node_id) {
+                    outFile << endl << to_file_id(i) << " " << to_file_id(edge.destination_node_id) << " " << edge.weight;
+                }
+            }
+        }
+        outFile.close();
+        if (!outFile) {
+            cerr << "Error: Could not write map file: '" << temp_filename << "'" << endl;
+            remove(temp_filename.c_str());
+            return false;
+        }
+        if (rename(temp_filename.c_str(), filename.c_str()) != 0) {
+            cerr << "Error: Could not replace map file: '" << filename << "'" << endl;
+            remove(temp_filename.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    void setNodesFilename(string const &name) { nodes_filename = name; }
+    void setEdgesFilename(string const &name) { edges_filename = name; }
+    string getNodesFilename() { return nodes_filename; }
+    string getEdgesFilename() { return edges_filename; }
+    string getUniversityName() { return university_name; }
+
+    ~Map() {};
+};
+
+#endif // MAP_H
@@ -0,0 +1,137 @@
+#ifndef NAME_INDEX_H
+#define NAME_INDEX_H
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "name_arena.h"
+
+using namespace std;
+
+// Sorted index of stop names for exact and prefix lookups.
+//
+// The entries are kept in a few sorted runs whose sizes roughly halve from one run to the next (a
+// log-structured merge): an insert goes into the last run, and once that run holds SMALL_RUN
+// entries it is merged into its neighbours while they are no larger. n inserts cost O(n log n)
+// overall and a lookup is one binary search per run, of which there are at most log2(n).
+// build() sorts a whole load at once instead.
+//
+// Entries are (name offset, stop ID) pairs ordered by the names they point to in the graph's
+// NameArena, which every call takes. Entries are never removed. Renaming a stop leaves its old
+// entry behind, so every lookup takes a predicate telling whether (id, offset) is still current
+// and skips the stale ones.
+class NameIndex {
+public:
+    struct Entry {
+        uint32_t name_offset;
+        int id;
+    };
+
+private:
+    vector<vector<Entry>> runs;   // Largest first
+
+    static const size_t SMALL_RUN = 32;
+
+    static bool less(const NameArena& arena, const Entry& a, const Entry& b) {
+        int order = arena.view(a.name_offset).compare(arena.view(b.name_offset));
+        return order != 0 ? order < 0 : a.id < b.id;
+    }
+
+    static bool hasPrefix(string_view name, string_view prefix) {
+        return name.substr(0, prefix.size()) == prefix;
+    }
+
+    static vector<Entry>::const_iterator firstAtLeast(const NameArena& arena, const vector<Entry>& run, string_view name) {
+        return lower_bound(run.begin(), run.end(), name,
+                           [&arena](const Entry& entry, string_view key) { return arena.view(entry.name_offset) < key; });
+    }
+
+public:
+    NameIndex() = default;
+
+    void clear() { runs.clear(); }
+
+    void insert(const NameArena& arena, uint32_t name_offset, int id) {
+        Entry entry{name_offset, id};
+        // Small runs are filled in place, so most inserts allocate nothing
+        if (!runs.empty() && runs.back().size() < SMALL_RUN) {
+            vector<Entry>& run = runs.back();
+            run.insert(upper_bound(run.begin(), run.end(), entry,
+                                   [&arena](const Entry& a, const Entry& b) { return less(arena, a, b); }), entry);
+        } else {
+            runs.push_back(vector<Entry>());
+            runs.back().reserve(SMALL_RUN);
+            runs.back().push_back(entry);
+        }
+        while (runs.size() >= 2 && runs[runs.size() - 2].size() <= runs.back().size()) {
+            vector<Entry>& left = runs[runs.size() - 2];
+            vector<Entry>& right = runs.back();
+            vector<Entry> merged;
+            merged.reserve(left.size() + right.size());
+            merge(left.begin(), left.end(), right.begin(), right.end(), back_inserter(merged),
+                  [&arena](const Entry& a, const Entry& b) { return less(arena, a, b); });
+            runs.pop_back();
+            runs.back() = move(merged);
+        }
+    }
+
+    // Replace the index with the given entries in one sort
+    void build(const NameArena& arena, vector<Entry> entries) {
+        runs.clear();
+        if (entries.empty()) return;
+        sort(entries.begin(), entries.end(), [&arena](const Entry& a, const Entry& b) { return less(arena, a, b); });
+        runs.push_back(move(entries));
+    }
+
+    // Lowest current ID whose name is the interned name_offset, or -1
+    template <class IsCurrent>
+    int find(const NameArena& arena, uint32_t name_offset, IsCurrent isCurrent) const {
+        string_view name = arena.view(name_offset);
+        int best = -1;
+        for (const vector<Entry>& run : runs) {
+            for (auto it = firstAtLeast(arena, run, name); it != run.end() && it->name_offset == name_offset; ++it) {
+                if (isCurrent(it->id, it->name_offset)) {
+                    if (best == -1 || it->id < best) best = it->id;
+                    break; // Later entries in this run have larger IDs
+                }
+            }
+        }
+        return best;
+    }
+
+    // IDs of up to limit current names starting with prefix, in alphabetical order
+    template <class IsCurrent>
+    vector<int> findPrefix(const NameArena& arena, string_view prefix, size_t limit, IsCurrent isCurrent) const {
+        // The first limit matches of every run are enough to find the first limit overall
+        vector<Entry> matches;
+        for (const vector<Entry>& run : runs) {
+            size_t taken = 0;
+            for (auto it = firstAtLeast(arena, run, prefix);
+                 it != run.end() && taken < limit && hasPrefix(arena.view(it->name_offset), prefix); ++it) {
+                if (isCurrent(it->id, it->name_offset)) {
+                    matches.push_back(*it);
+                    taken++;
+                }
+            }
+        }
+        sort(matches.begin(), matches.end(), [&arena](const Entry& a, const Entry& b) { return less(arena, a, b); });
+
+        vector<int> ids;
+        for (size_t i = 0; i < matches.size() && ids.size() < limit; i++) {
+            // The same stop can appear in two runs if it was given the same name twice
+            if (i > 0 && matches[i - 1].id == matches[i].id && matches[i - 1].name_offset == matches[i].name_offset) continue;
+            ids.push_back(matches[i].id);
+        }
+        return ids;
+    }
+
+    size_t sizeInBytes() const {
+        size_t bytes = runs.capacity() * sizeof(vector<Entry>);
+        for (const vector<Entry>& run : runs) bytes += run.capacity() * sizeof(Entry);
+        return bytes;
+    }
+};
+
+#endif // NAME_INDEX_H
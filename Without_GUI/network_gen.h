@@ -0,0 +1,330 @@
+#ifndef NETWORK_GEN_H
+#define NETWORK_GEN_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Synthetic transit networks for scale testing, written in the formats Map::map_to_graph reads.
+//
+// Stops are numbered 0..num_stops-1 with the university at 0, and every stop can reach it: after
+// the network is drawn, each disconnected piece gets one feeder road into the university's piece.
+// Work is split into fixed chunks of stops, each with its own random stream derived from the seed
+// and the chunk number, so the same seed gives the same files whatever the thread count.
+enum NetworkKind {
+    NETWORK_GRID,           // Streets on a square grid, 1-10 minutes per block
+    NETWORK_GEOMETRIC,      // Stops scattered over a square, roads between stops closer than a radius
+    NETWORK_HUB_AND_SPOKE,  // Interchange hubs on a ring with express links, branch lines out of each hub
+    NETWORK_SCALE_FREE      // Power-law degrees (Chung-Lu): a few very busy stops, many quiet ones
+};
+
+struct GeneratedRoad {
+    int source;
+    int destination;
+    int minutes;
+};
+
+struct NetworkSpec {
+    NetworkKind kind = NETWORK_GRID;
+    int num_stops = 1000;
+    uint64_t seed = 1;
+    unsigned threads = 1;
+    string university_name = "EUI_Campus";
+};
+
+class NetworkGenerator {
+private:
+    static const int CHUNK = 1 << 16;           // Stops per work item and random stream
+    static const int HUB_SPOKE_STOPS = 1000;    // Stops served by each hub
+    static const int BRANCH_LENGTH = 8;         // Stops per branch line
+
+    NetworkSpec spec;
+
+    static uint64_t mix(uint64_t value) {       // splitmix64 finaliser
+        value += 0x9E3779B97F4A7C15ULL;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31);
+    }
+
+    mt19937_64 streamFor(uint64_t purpose, uint64_t chunk) const {
+        return mt19937_64(mix(spec.seed ^ mix(purpose * 0x100000001B3ULL + chunk)));
+    }
+
+    int numChunks() const { return (spec.num_stops + CHUNK - 1) / CHUNK; }
+
+    // Run work(chunk) for every chunk on spec.threads threads
+    void forEachChunk(int chunks, const function<void(int)>& work) const {
+        unsigned workers = max(1u, min(spec.threads, static_cast<unsigned>(max(1, chunks))));
+        vector<thread> pool;
+        for (unsigned w = 0; w < workers; w++) {
+            pool.emplace_back([&, w]() {
+                for (int chunk = static_cast<int>(w); chunk < chunks; chunk += static_cast<int>(workers)) work(chunk);
+            });
+        }
+        for (thread& worker : pool) worker.join();
+    }
+
+    // Generate per-chunk road lists in parallel and concatenate them in chunk order
+    vector<GeneratedRoad> collect(int chunks, const function<void(int, vector<GeneratedRoad>&)>& work) const {
+        vector<vector<GeneratedRoad>> parts(chunks);
+        forEachChunk(chunks, [&](int chunk) { work(chunk, parts[chunk]); });
+        size_t total = 0;
+        for (const vector<GeneratedRoad>& part : parts) total += part.size();
+        vector<GeneratedRoad> roads;
+        roads.reserve(total);
+        for (vector<GeneratedRoad>& part : parts) {
+            roads.insert(roads.end(), part.begin(), part.end());
+            vector<GeneratedRoad>().swap(part);
+        }
+        return roads;
+    }
+
+    vector<GeneratedRoad> grid() const {
+        int n = spec.num_stops;
+        int side = max(1, static_cast<int>(ceil(sqrt(static_cast<double>(n)))));
+        return collect(numChunks(), [&](int chunk, vector<GeneratedRoad>& roads) {
+            mt19937_64 rng = streamFor(NETWORK_GRID, chunk);
+            uniform_int_distribution<int> minutes(1, 10);
+            int last = min(n, (chunk + 1) * CHUNK);
+            for (int id = chunk * CHUNK; id < last; id++) {
+                if (id % side + 1 < side && id + 1 < n) roads.push_back(GeneratedRoad{id, id + 1, minutes(rng)});
+                if (id + side < n) roads.push_back(GeneratedRoad{id, id + side, minutes(rng)});
+            }
+        });
+    }
+
+    // Roads between stops closer than a radius chosen for about five neighbours each, taking
+    // 1 minute for stops next to each other up to 10 minutes at the full radius
+    vector<GeneratedRoad> geometric() const {
+        int n = spec.num_stops;
+        vector<float> x(n), y(n);
+        forEachChunk(numChunks(), [&](int chunk) {
+            mt19937_64 rng = streamFor(100 + NETWORK_GEOMETRIC, chunk);
+            uniform_real_distribution<float> unit(0.0f, 1.0f);
+            for (int id = chunk * CHUNK; id < min(n, (chunk + 1) * CHUNK); id++) {
+                x[id] = unit(rng);
+                y[id] = unit(rng);
+            }
+        });
+        x[0] = y[0] = 0.5f; // University in the middle of town
+
+        const double PI = 3.14159265358979323846;
+        double radius = sqrt(5.0 / (PI * max(1, n)));
+        int cells_per_side = max(1, min(static_cast<int>(1.0 / radius), 1 << 12));
+        auto cellOf = [cells_per_side](float coordinate) {
+            return min(cells_per_side - 1, static_cast<int>(coordinate * cells_per_side));
+        };
+        // Counting sort of stops into cells
+        vector<int> cell_start(static_cast<size_t>(cells_per_side) * cells_per_side + 1, 0);
+        for (int id = 0; id < n; id++) cell_start[static_cast<size_t>(cellOf(y[id])) * cells_per_side + cellOf(x[id]) + 1]++;
+        for (size_t c = 1; c < cell_start.size(); c++) cell_start[c] += cell_start[c - 1];
+        vector<int> cell_stops(n);
+        vector<int> fill(cell_start.begin(), cell_start.end() - 1);
+        for (int id = 0; id < n; id++) cell_stops[fill[static_cast<size_t>(cellOf(y[id])) * cells_per_side + cellOf(x[id])]++] = id;
+
+        double radius_squared = radius * radius;
+        return collect(numChunks(), [&](int chunk, vector<GeneratedRoad>& roads) {
+            for (int id = chunk * CHUNK; id < min(n, (chunk + 1) * CHUNK); id++) {
+                int cx = cellOf(x[id]), cy = cellOf(y[id]);
+                for (int ny = max(0, cy - 1); ny <= min(cells_per_side - 1, cy + 1); ny++) {
+                    for (int nx = max(0, cx - 1); nx <= min(cells_per_side - 1, cx + 1); nx++) {
+                        size_t cell = static_cast<size_t>(ny) * cells_per_side + nx;
+                        for (int k = cell_start[cell]; k < cell_start[cell + 1]; k++) {
+                            int other = cell_stops[k];
+                            if (other <= id) continue; // Each pair once
+                            double dx = x[id] - x[other], dy = y[id] - y[other];
+                            double distance_squared = dx * dx + dy * dy;
+                            if (distance_squared > radius_squared) continue;
+                            int minutes = 1 + static_cast<int>(lround(sqrt(distance_squared) / radius * 9.0));
+                            roads.push_back(GeneratedRoad{id, other, minutes});
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    // Stops 0..hubs-1 are hubs (the university is hub 0) on a ring with two express links each;
+    // every other stop sits on a branch line that starts at a hub
+    vector<GeneratedRoad> hubAndSpoke() const {
+        int n = spec.num_stops;
+        int hubs = max(1, n / HUB_SPOKE_STOPS);
+        vector<GeneratedRoad> roads = collect(numChunks(), [&](int chunk, vector<GeneratedRoad>& part) {
+            mt19937_64 rng = streamFor(NETWORK_HUB_AND_SPOKE, chunk);
+            uniform_int_distribution<int> local(2, 6);
+            for (int id = max(hubs, chunk * CHUNK); id < min(n, (chunk + 1) * CHUNK); id++) {
+                int position = (id - hubs) % BRANCH_LENGTH;
+                int hub = ((id - hubs) / BRANCH_LENGTH) % hubs;
+                part.push_back(GeneratedRoad{position == 0 ? hub : id - 1, id, local(rng)});
+            }
+        });
+        mt19937_64 rng = streamFor(200 + NETWORK_HUB_AND_SPOKE, 0);
+        uniform_int_distribution<int> express(5, 25), anyHub(0, hubs - 1);
+        for (int hub = 0; hub < hubs && hubs > 1; hub++) {
+            roads.push_back(GeneratedRoad{hub, (hub + 1) % hubs, express(rng)});
+            for (int link = 0; link < 2; link++) {
+                int other = anyHub(rng);
+                if (other != hub) roads.push_back(GeneratedRoad{hub, other, express(rng)});
+            }
+        }
+        return roads;
+    }
+
+    // Chung-Lu graph: stop i has expected degree proportional to (i + 1)^(-2/3), a power law with
+    // exponent 2.5, and about two roads per stop overall. Endpoints are drawn by binary search in
+    // the cumulative weights, so chunks need no shared state.
+    vector<GeneratedRoad> scaleFree() const {
+        int n = spec.num_stops;
+        vector<double> cumulative(n);
+        double total = 0;
+        for (int id = 0; id < n; id++) {
+            total += pow(id + 1.0, -2.0 / 3.0);
+            cumulative[id] = total;
+        }
+        return collect(numChunks(), [&](int chunk, vector<GeneratedRoad>& roads) {
+            mt19937_64 rng = streamFor(NETWORK_SCALE_FREE, chunk);
+            uniform_real_distribution<double> pick(0.0, total);
+            uniform_int_distribution<int> minutes(2, 15);
+            int stops_in_chunk = min(n, (chunk + 1) * CHUNK) - chunk * CHUNK;
+            for (int i = 0; i < 2 * stops_in_chunk; i++) {
+                int a = static_cast<int>(lower_bound(cumulative.begin(), cumulative.end(), pick(rng)) - cumulative.begin());
+                int b = static_cast<int>(lower_bound(cumulative.begin(), cumulative.end(), pick(rng)) - cumulative.begin());
+                a = min(a, n - 1);
+                b = min(b, n - 1);
+                if (a != b) roads.push_back(GeneratedRoad{a, b, minutes(rng)});
+            }
+        });
+    }
+
+    static int findRoot(vector<int>& parent, int id) {
+        while (parent[id] != id) {
+            parent[id] = parent[parent[id]];
+            id = parent[id];
+        }
+        return id;
+    }
+
+    // Give every piece that cannot reach the university one feeder road into the university's piece
+    void connectToUniversity(vector<GeneratedRoad>& roads) const {
+        int n = spec.num_stops;
+        vector<int> parent(n);
+        for (int id = 0; id < n; id++) parent[id] = id;
+        for (const GeneratedRoad& road : roads) {
+            int a = findRoot(parent, road.source), b = findRoot(parent, road.destination);
+            if (a != b) parent[max(a, b)] = min(a, b); // Roots are the smallest IDs, so 0 stays a root
+        }
+        vector<int> connected; // Stops already reaching the university, to attach feeders to
+        for (int id = 0; id < n; id++) {
+            if (findRoot(parent, id) == 0) connected.push_back(id);
+        }
+        mt19937_64 rng = streamFor(300 + spec.kind, 0);
+        uniform_int_distribution<int> minutes(5, 20);
+        for (int id = 1; id < n; id++) {
+            if (parent[id] != id) continue; // Not the smallest stop of its piece
+            int target = connected[uniform_int_distribution<size_t>(0, connected.size() - 1)(rng)];
+            roads.push_back(GeneratedRoad{id, target, minutes(rng)});
+        }
+    }
+
+    // Format roads in parallel, then write the chunks in order
+    bool writeRoads(ofstream& out, const vector<GeneratedRoad>& roads, const function<int(int)>& fileId) const {
+        const size_t ROADS_PER_CHUNK = 1 << 16;
+        int chunks = static_cast<int>((roads.size() + ROADS_PER_CHUNK - 1) / ROADS_PER_CHUNK);
+        vector<string> text(chunks);
+        forEachChunk(chunks, [&](int chunk) {
+            char line[48];
+            size_t last = min(roads.size(), (chunk + 1) * ROADS_PER_CHUNK);
+            for (size_t i = chunk * ROADS_PER_CHUNK; i < last; i++) {
+                int length = snprintf(line, sizeof(line), "%d %d %d\n", fileId(roads[i].source),
+                                      fileId(roads[i].destination), roads[i].minutes);
+                text[chunk].append(line, length);
+            }
+        });
+        for (const string& part : text) out << part;
+        return static_cast<bool>(out);
+    }
+
+public:
+    NetworkGenerator(const NetworkSpec& network) : spec(network) {}
+
+    static bool parseKind(const string& name, NetworkKind& kind) {
+        if (name == "grid") kind = NETWORK_GRID;
+        else if (name == "geometric") kind = NETWORK_GEOMETRIC;
+        else if (name == "hub" || name == "hub-and-spoke") kind = NETWORK_HUB_AND_SPOKE;
+        else if (name == "scale-free") kind = NETWORK_SCALE_FREE;
+        else return false;
+        return true;
+    }
+
+    static string stopName(int id) { return "Stop_" + to_string(id); }
+
+    // Every road once, each stop reachable from the university
+    vector<GeneratedRoad> generate() const {
+        vector<GeneratedRoad> roads;
+        if (spec.num_stops < 1) return roads;
+        switch (spec.kind) {
+            case NETWORK_GRID: roads = grid(); break;
+            case NETWORK_GEOMETRIC: roads = geometric(); break;
+            case NETWORK_HUB_AND_SPOKE: roads = hubAndSpoke(); break;
+            case NETWORK_SCALE_FREE: roads = scaleFree(); break;
+        }
+        connectToUniversity(roads);
+        return roads;
+    }
+
+    // nodes.txt ("id name") and edges.txt ("source dest minutes"), the university as stop 0
+    bool writeSplitFiles(const vector<GeneratedRoad>& roads, const string& nodes_filename, const string& edges_filename) const {
+        ofstream nodesFile(nodes_filename);
+        if (!nodesFile.is_open()) {
+            cerr << "Error: Could not open nodes file for writing: '" << nodes_filename << "'" << endl;
+            return false;
+        }
+        nodesFile << 0 << " " << spec.university_name;
+        for (int id = 1; id < spec.num_stops; id++) nodesFile << "\n" << id << " " << stopName(id);
+        nodesFile << "\n";
+
+        ofstream edgesFile(edges_filename);
+        if (!edgesFile.is_open()) {
+            cerr << "Error: Could not open edges file for writing: '" << edges_filename << "'" << endl;
+            return false;
+        }
+        bool written = writeRoads(edgesFile, roads, [](int id) { return id; });
+        if (!written || !nodesFile || !edgesFile) {
+            cerr << "Error: Could not finish writing '" << nodes_filename << "' and '" << edges_filename << "'" << endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Summer_Routes.txt layout, as Map::save_single_file writes it: the university is unnumbered
+    // in the file and edges refer to it as the stop count, so graph stop i is file stop i - 1
+    bool writeSingleFile(const vector<GeneratedRoad>& roads, const string& filename) const {
+        ofstream outFile(filename);
+        if (!outFile.is_open()) {
+            cerr << "Error: Could not open map file for writing: '" << filename << "'" << endl;
+            return false;
+        }
+        int node_count = spec.num_stops - 1;
+        outFile << node_count;
+        for (int id = 1; id <= node_count; id++) outFile << "\n" << id - 1 << " " << stopName(id);
+        outFile << "\n" << spec.university_name << "\n";
+        if (!writeRoads(outFile, roads, [node_count](int id) { return id == 0 ? node_count : id - 1; })) {
+            cerr << "Error: Could not finish writing '" << filename << "'" << endl;
+            return false;
+        }
+        return true;
+    }
+};
+
+#endif // NETWORK_GEN_H
@@ -0,0 +1,119 @@
+#ifndef PARETO_H
+#define PARETO_H
+
+#include <algorithm>
+#include <vector>
+#include <queue>
+#include "graphV1.h"
+
+using namespace std;
+
+// Bi-criteria route search: travel time and number of stops at once.
+// Labels are settled in (weight, stops) order, so every label settled at a node weighs no less than
+// the ones before it; a new label is therefore non-dominated exactly when it uses fewer stops than
+// every label already settled there. All labels live in one pool that is kept between queries,
+// and parents are pool indices, so no per-label allocation happens once the pool has grown.
+class ParetoSearch {
+private:
+    struct RouteLabel {
+        double weight;
+        int stops;
+        int node_id;
+        int parent;     // Pool index of the label this one extends, -1 at the start
+    };
+
+    const Graph& graph;
+    vector<RouteLabel> pool;
+    vector<int> min_settled_stops;  // Fewest stops among labels settled at each node
+    vector<int> touched_nodes;
+    SearchStats last_stats;
+
+    void reset() {
+        for (int v : touched_nodes) min_settled_stops[v] = INT_INF;
+        touched_nodes.clear();
+        pool.clear(); // Keeps capacity for the next query
+    }
+
+    PathDetails buildPath(int label_index) const {
+        PathDetails result;
+        result.path_exists = true;
+        result.total_weight = pool[label_index].weight;
+        result.num_stops = pool[label_index].stops;
+        for (int i = label_index; i != -1; i = pool[i].parent) {
+            result.node_ids_in_path.push_back(pool[i].node_id);
+        }
+        reverse(result.node_ids_in_path.begin(), result.node_ids_in_path.end());
+        return result;
+    }
+
+public:
+    ParetoSearch(const Graph& g) : graph(g) {}
+
+    // Every non-dominated (total_weight, num_stops) route, fastest first.
+    // The first entry equals Dijkstra's answer in weight and the last equals BFS's in stops.
+    template <class Stats = NoSearchStats>
+    vector<PathDetails> search(int startNodeId, int endNodeId) {
+        TraceSpan span("Pareto routes", "search");
+        Stats counters;
+        last_stats = SearchStats();
+        vector<PathDetails> routes;
+        int numNodes = graph.getNumNodes();
+        if (startNodeId >= numNodes || endNodeId >= numNodes || startNodeId < 0 || endNodeId < 0) {
+            cerr << "Error: Invalid start or end node ID in Pareto search." << endl;
+            return routes;
+        }
+
+        if (static_cast<int>(min_settled_stops.size()) < numNodes) {
+            min_settled_stops.resize(numNodes, INT_INF);
+        }
+        reset();
+
+        typedef pair<pair<double, int>, int> QueueEntry; // ((weight, stops), pool index)
+        priority_queue<QueueEntry, vector<QueueEntry>, greater<QueueEntry>> pq;
+        pool.push_back(RouteLabel{0.0, 0, startNodeId, -1});
+        pq.push({{0.0, 0}, 0});
+        counters.pushed(pq.size());
+
+        while (!pq.empty()) {
+            int label_index = pq.top().second;
+            pq.pop();
+            counters.popped();
+            RouteLabel label = pool[label_index];
+
+            // Dominated by a label settled earlier (which weighs no more)
+            if (label.stops >= min_settled_stops[label.node_id]) {
+                counters.stale();
+                continue;
+            }
+            counters.settled();
+            if (min_settled_stops[label.node_id] == INT_INF) touched_nodes.push_back(label.node_id);
+            min_settled_stops[label.node_id] = label.stops;
+
+            if (label.node_id == endNodeId) {
+                routes.push_back(buildPath(label_index));
+                if (label.stops <= 1) break; // Nothing can use fewer stops
+                continue;
+            }
+
+            for (const Edge& edge : graph.getEdges(label.node_id)) {
+                counters.relaxed();
+                int next_stops = label.stops + 1;
+                // Prune against the destination too: its settled routes are all at least as fast
+                if (next_stops >= min_settled_stops[edge.destination_node_id] ||
+                    next_stops >= min_settled_stops[endNodeId]) {
+                    continue;
+                }
+                pool.push_back(RouteLabel{label.weight + edge.weight, next_stops, edge.destination_node_id, label_index});
+                pq.push({{label.weight + edge.weight, next_stops}, static_cast<int>(pool.size()) - 1});
+                counters.pushed(pq.size());
+            }
+        }
+        counters.finish(last_stats);
+        return routes;
+    }
+
+    // Instrumentation of the last search; collected only when it ran with CountSearchStats
+    const SearchStats& lastStats() const { return last_stats; }
+};
+
+#endif // PARETO_H
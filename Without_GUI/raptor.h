@@ -0,0 +1,374 @@
+#ifndef RAPTOR_H
+#define RAPTOR_H
+
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include "timetable.h"
+#include "trace.h"
+
+using namespace std;
+
+// Round-based public transit routing (RAPTOR).
+// Round k relaxes every route touched in round k - 1, so after round k the labels hold the
+// earliest arrival using at most k trips. An engine owns its label arrays and is reused across
+// queries; use one engine per thread.
+class RaptorEngine {
+private:
+    enum LabelKind { LABEL_NONE = 0, LABEL_TRIP, LABEL_FOOTPATH };
+
+    struct Parent {
+        int kind = LABEL_NONE;
+        int route_id = -1;
+        int trip = -1;
+        int board_index = -1;   // Trip label: stop index where the trip was boarded
+        int board_round = -1;   // Trip label: round whose label the boarding used
+        int from_stop_id = -1;  // Trip label: boarding stop. Footpath label: stop walked from
+    };
+
+    const Timetable& timetable;
+    int max_rounds = 0;
+
+    vector<int> labels;          // labels[k * numStops + s]: arrival at s with at most k trips
+    vector<Parent> parents;      // same layout as labels
+    vector<int> best_arrival;    // best over all rounds, used for pruning
+    vector<int> ride_labels;     // ride_labels[k * numStops + s]: arrival at s on the k-th trip (round 0: origin)
+    vector<Parent> ride_parents; // walks start from these, even where a walk already got there earlier
+    vector<int> best_ride;
+    vector<int> walk_from;       // stops given a ride label this round
+    vector<char> marked;
+    vector<int> marked_stops;
+    vector<int> touched_stops;   // stops with a non-INF label, reset lazily between queries
+    vector<int> route_queue;     // route_queue[r]: earliest marked stop index on r, -1 if unqueued
+    vector<int> queued_routes;
+
+    int label(int round, int stop_id) const { return labels[round * timetable.numStops + stop_id]; }
+
+    void ensureRounds(int rounds) {
+        if (rounds <= max_rounds && !labels.empty()) return;
+        max_rounds = rounds;
+        labels.assign((rounds + 1) * timetable.numStops, TIME_INF);
+        parents.assign((rounds + 1) * timetable.numStops, Parent());
+        ride_labels.assign((rounds + 1) * timetable.numStops, TIME_INF);
+        ride_parents.assign((rounds + 1) * timetable.numStops, Parent());
+        best_ride.assign(timetable.numStops, TIME_INF);
+        // touched_stops no longer matches the fresh labels, so reset() cannot be trusted with
+        // best_arrival either: start it over too
+        best_arrival.assign(timetable.numStops, TIME_INF);
+        touched_stops.clear();
+    }
+
+    void reset() {
+        int n = timetable.numStops;
+        for (int s : touched_stops) {
+            for (int k = 0; k <= max_rounds; k++) {
+                labels[k * n + s] = TIME_INF;
+                parents[k * n + s] = Parent();
+                ride_labels[k * n + s] = TIME_INF;
+                ride_parents[k * n + s] = Parent();
+            }
+            best_arrival[s] = TIME_INF;
+            best_ride[s] = TIME_INF;
+        }
+        touched_stops.clear();
+    }
+
+    bool improve(int round, int stop_id, int time, const Parent& parent, int target_stop_id) {
+        // Target pruning: nothing arriving after the best time at the target can be useful
+        if (time >= best_arrival[stop_id] || time >= best_arrival[target_stop_id]) {
+            return false;
+        }
+        int index = round * timetable.numStops + stop_id;
+        if (best_arrival[stop_id] == TIME_INF) touched_stops.push_back(stop_id);
+        labels[index] = time;
+        parents[index] = parent;
+        best_arrival[stop_id] = time;
+        if (!marked[stop_id]) {
+            marked[stop_id] = 1;
+            marked_stops.push_back(stop_id);
+        }
+        return true;
+    }
+
+    // A trip (or the origin) reaching stop_id. Walks must not chain, so the ride keeps its own
+    // label to walk on from even when it loses to a walk that got there first. Returns whether
+    // it also improved the stop's label.
+    bool arrive(int round, int stop_id, int time, const Parent& parent, int target_stop_id) {
+        if (time >= best_ride[stop_id] || time >= best_arrival[target_stop_id]) {
+            return false;
+        }
+        int index = round * timetable.numStops + stop_id;
+        if (ride_labels[index] == TIME_INF) walk_from.push_back(stop_id);
+        ride_labels[index] = time;
+        ride_parents[index] = parent;
+        best_ride[stop_id] = time;
+        return improve(round, stop_id, time, parent, target_stop_id);
+    }
+
+    // Earliest trip of the route departing stop_index at or after time, -1 if none
+    int earliestTrip(int route_id, int stop_index, int time) const {
+        int low = 0, high = timetable.getNumTrips(route_id);
+        while (low < high) {
+            int mid = (low + high) / 2;
+            if (timetable.getTripTime(route_id, mid, stop_index) < time) low = mid + 1;
+            else high = mid;
+        }
+        return low < timetable.getNumTrips(route_id) ? low : -1;
+    }
+
+    // Walk from the stops given a ride label this round; walks never chain
+    template <class Stats>
+    void relaxFootpaths(int round, int target_stop_id, Stats& counters) {
+        int n = timetable.numStops;
+        for (int s : walk_from) {
+            int arrival = ride_labels[round * n + s];
+            for (int f = timetable.footpath_offset[s]; f < timetable.footpath_offset[s + 1]; f++) {
+                const Footpath& walk = timetable.footpaths[f];
+                Parent parent;
+                parent.kind = LABEL_FOOTPATH;
+                parent.from_stop_id = s;
+                counters.relaxed();
+                if (improve(round, walk.destination_stop_id, arrival + walk.duration, parent, target_stop_id)) {
+                    counters.settled();
+                }
+            }
+        }
+    }
+
+    Journey buildJourney(int source_stop_id, int target_stop_id, int departure_time) const {
+        Journey journey;
+        int n = timetable.numStops;
+        int best_round = -1;
+        for (int k = 0; k <= max_rounds; k++) {
+            if (label(k, target_stop_id) != TIME_INF &&
+                (best_round == -1 || label(k, target_stop_id) < label(best_round, target_stop_id))) {
+                best_round = k;
+            }
+        }
+        if (best_round == -1) return journey;
+
+        journey.journey_exists = true;
+        journey.departure_time = departure_time;
+        journey.arrival_time = label(best_round, target_stop_id);
+
+        // A walk started from a ride label, so the stop before it is read from the ride arrays
+        int round = best_round;
+        int stop_id = target_stop_id;
+        bool walked = false;
+        while (true) {
+            int index = round * n + stop_id;
+            const Parent& parent = walked ? ride_parents[index] : parents[index];
+            JourneyLeg leg;
+            leg.alight_stop_id = stop_id;
+            leg.alight_time = walked ? ride_labels[index] : labels[index];
+            leg.board_stop_id = parent.from_stop_id;
+            if (parent.kind == LABEL_TRIP) {
+                leg.route_id = parent.route_id;
+                leg.board_time = timetable.getTripTime(parent.route_id, parent.trip, parent.board_index);
+                round = parent.board_round;
+                walked = false;
+            } else if (parent.kind == LABEL_FOOTPATH) {
+                leg.board_time = ride_labels[round * n + parent.from_stop_id];
+                walked = true;
+            } else {
+                break;
+            }
+            journey.legs.push_back(leg);
+            stop_id = parent.from_stop_id;
+        }
+        reverse(journey.legs.begin(), journey.legs.end());
+
+        // The traveller can leave as late as the first boarding allows
+        if (!journey.legs.empty() && journey.legs.front().route_id != -1) {
+            journey.departure_time = journey.legs.front().board_time;
+        }
+
+        journey.node_ids_in_path.push_back(source_stop_id);
+        int trips = 0;
+        for (size_t l = 0; l < journey.legs.size(); l++) {
+            const JourneyLeg& leg = journey.legs[l];
+            if (leg.route_id == -1) {
+                journey.node_ids_in_path.push_back(leg.alight_stop_id);
+                continue;
+            }
+            trips++;
+            int length = timetable.getRouteLength(leg.route_id);
+            int i = 0;
+            while (i < length && timetable.getRouteStop(leg.route_id, i) != leg.board_stop_id) i++;
+            for (i = i + 1; i < length; i++) {
+                int s = timetable.getRouteStop(leg.route_id, i);
+                journey.node_ids_in_path.push_back(s);
+                if (s == leg.alight_stop_id) break;
+            }
+        }
+        journey.num_transfers = max(0, trips - 1);
+        return journey;
+    }
+
+public:
+    RaptorEngine(const Timetable& tt) : timetable(tt) {
+        best_arrival.assign(tt.numStops, TIME_INF);
+        marked.assign(tt.numStops, 0);
+        route_queue.assign(tt.getNumRoutes(), -1);
+    }
+
+    // Earliest arrival at target leaving source no earlier than departure_time,
+    // using at most max_transfers changes of bus. With CountSearchStats, routes queued for a round
+    // count as queue pushes and pops.
+    template <class Stats = NoSearchStats>
+    Journey earliestArrival(int source_stop_id, int target_stop_id, int departure_time, int max_transfers) {
+        TraceSpan span("RAPTOR earliest arrival", "search");
+        Stats counters;
+        Journey result;
+        int n = timetable.numStops;
+        if (source_stop_id < 0 || target_stop_id < 0 || source_stop_id >= n || target_stop_id >= n || max_transfers < 0) {
+            cerr << "Error: Invalid stop ID or transfer limit in RAPTOR query." << endl;
+            return result;
+        }
+
+        ensureRounds(max_transfers + 1);
+        reset();
+
+        // Round 0: the origin and everything walkable from it
+        marked_stops.clear();
+        Parent origin;
+        walk_from.clear();
+        arrive(0, source_stop_id, departure_time, origin, target_stop_id);
+        counters.settled();
+        relaxFootpaths(0, target_stop_id, counters);
+
+        for (int k = 1; k <= max_transfers + 1 && !marked_stops.empty(); k++) {
+            // Collect routes through marked stops, remembering the earliest stop to board at
+            queued_routes.clear();
+            for (int s : marked_stops) {
+                marked[s] = 0;
+                for (int i = timetable.stop_route_offset[s]; i < timetable.stop_route_offset[s + 1]; i++) {
+                    const Timetable::RouteStop& rs = timetable.stop_routes[i];
+                    if (route_queue[rs.route_id] == -1) {
+                        queued_routes.push_back(rs.route_id);
+                        counters.pushed(queued_routes.size());
+                        route_queue[rs.route_id] = rs.stop_index;
+                    } else if (rs.stop_index < route_queue[rs.route_id]) {
+                        route_queue[rs.route_id] = rs.stop_index;
+                    }
+                }
+            }
+            marked_stops.clear();
+            walk_from.clear();
+
+            // Scan each queued route once, hopping on the earliest catchable trip
+            for (int r : queued_routes) {
+                counters.popped();
+                int length = timetable.getRouteLength(r);
+                int trip = -1;
+                int board_index = -1;
+                int board_round = -1;
+                int board_stop_id = -1;
+                for (int i = route_queue[r]; i < length; i++) {
+                    int s = timetable.getRouteStop(r, i);
+                    counters.relaxed();
+                    if (trip != -1) {
+                        Parent parent;
+                        parent.kind = LABEL_TRIP;
+                        parent.route_id = r;
+                        parent.trip = trip;
+                        parent.board_index = board_index;
+                        parent.board_round = board_round;
+                        parent.from_stop_id = board_stop_id;
+                        if (arrive(k, s, timetable.getTripTime(r, trip, i), parent, target_stop_id)) {
+                            counters.settled();
+                        }
+                    }
+                    // Latest label from earlier rounds = best arrival with at most k - 1 trips
+                    int ready_round = k - 1;
+                    while (ready_round > 0 && label(ready_round, s) == TIME_INF) ready_round--;
+                    int ready = label(ready_round, s);
+                    if (ready != TIME_INF && (trip == -1 || ready <= timetable.getTripTime(r, trip, i))) {
+                        int earlier = earliestTrip(r, i, ready);
+                        if (earlier != -1 && (trip == -1 || earlier < trip)) {
+                            trip = earlier;
+                            board_index = i;
+                            board_round = ready_round;
+                            board_stop_id = s;
+                        }
+                    }
+                }
+                route_queue[r] = -1;
+            }
+
+            relaxFootpaths(k, target_stop_id, counters);
+        }
+        for (int s : marked_stops) marked[s] = 0;
+        marked_stops.clear();
+
+        result = buildJourney(source_stop_id, target_stop_id, departure_time);
+        counters.finish(result.stats);
+        return result;
+    }
+};
+
+// Every non-dominated journey leaving source within [window_start, window_end]: a journey is kept
+// unless another one departs no earlier and arrives no later. Departure times are independent
+// queries, so they are split across worker threads, each with its own engine. Each journey carries
+// the stats of its own departure's query.
+template <class Stats = NoSearchStats>
+vector<Journey> raptorRangeQuery(const Timetable& timetable, int source_stop_id, int target_stop_id,
+                                 int window_start, int window_end, int max_transfers,
+                                 unsigned num_threads = thread::hardware_concurrency()) {
+    TraceSpan span("RAPTOR range query", "search");
+    vector<Journey> profile;
+    if (source_stop_id < 0 || source_stop_id >= timetable.numStops || target_stop_id < 0 || target_stop_id >= timetable.numStops) {
+        cerr << "Error: Invalid start or target stop ID in RAPTOR range query." << endl;
+        return profile;
+    }
+
+    // Only departures of trips from the source (or a stop walkable from it) can change the answer
+    vector<int> departures;
+    vector<pair<int, int>> origins; // (stop, walking time)
+    origins.push_back({source_stop_id, 0});
+    for (int f = timetable.footpath_offset[source_stop_id]; f < timetable.footpath_offset[source_stop_id + 1]; f++) {
+        origins.push_back({timetable.footpaths[f].destination_stop_id, timetable.footpaths[f].duration});
+    }
+    for (const pair<int, int>& origin : origins) {
+        int s = origin.first;
+        for (int i = timetable.stop_route_offset[s]; i < timetable.stop_route_offset[s + 1]; i++) {
+            const Timetable::RouteStop& rs = timetable.stop_routes[i];
+            for (int t = 0; t < timetable.getNumTrips(rs.route_id); t++) {
+                int leave = timetable.getTripTime(rs.route_id, t, rs.stop_index) - origin.second;
+                if (leave >= window_start && leave <= window_end) departures.push_back(leave);
+            }
+        }
+    }
+    sort(departures.begin(), departures.end());
+    departures.erase(unique(departures.begin(), departures.end()), departures.end());
+    if (departures.empty()) return profile;
+
+    vector<Journey> results(departures.size());
+    num_threads = max(1u, min(num_threads, static_cast<unsigned>(departures.size())));
+    atomic<size_t> next_query(0);
+    auto worker = [&]() {
+        RaptorEngine engine(timetable);
+        for (size_t q = next_query++; q < departures.size(); q = next_query++) {
+            results[q] = engine.template earliestArrival<Stats>(source_stop_id, target_stop_id, departures[q], max_transfers);
+        }
+    };
+    vector<thread> pool;
+    for (unsigned t = 1; t < num_threads; t++) pool.emplace_back(worker);
+    worker();
+    for (thread& t : pool) t.join();
+
+    // Scan from the latest departure backwards, keeping journeys that strictly beat every later one
+    int best_arrival = TIME_INF;
+    for (size_t q = results.size(); q-- > 0;) {
+        if (results[q].journey_exists && results[q].arrival_time < best_arrival) {
+            best_arrival = results[q].arrival_time;
+            profile.push_back(results[q]);
+        }
+    }
+    reverse(profile.begin(), profile.end());
+    return profile;
+}
+
+#endif // RAPTOR_H
@@ -0,0 +1,250 @@
+// Replays a query log (query_log.h) against a map and reports latency per algorithm.
+//
+// Build: g++ -std=c++17 -O2 -pthread replay.cpp -o commute_replay
+// Run:   ./commute_replay queries.bin nodes.txt edges.txt
+//        ./commute_replay --threads 8 --paced --speed 10 queries.bin Summer_Routes.txt
+//        ./commute_replay --timetable timetable.txt --repeat 5 queries.bin nodes.txt edges.txt
+//
+// Logs come from the frontends run with COMMUTE_QUERY_LOG=queries.bin. By default each thread
+// issues the next query as soon as it is free, for maximum throughput, and latency is the time a
+// query takes. With --paced, queries are issued at their recorded spacing (shortened by --speed)
+// and latency counts from the moment a query was due, so a replay that falls behind shows it as
+// latency instead of quietly slowing down. Queries naming stops the map does not have, and
+// timetable queries without --timetable, are skipped and counted.
+// Isochrones replay with their logged time limits; a query that had more than three keeps only
+// the three largest, which leaves the work the same (see QueryLog::recordIsochrone).
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <cstdio>
+#include "graphV1.h"
+#include "map.h"
+#include "timetable.h"
+#include "raptor.h"
+#include "csa.h"
+#include "pareto.h"
+#include "ksp.h"
+#include "alternatives.h"
+#include "isochrone.h"
+#include "route_search.h"
+#include "query_log.h"
+
+using namespace std;
+
+const int NUM_ALGORITHMS = QUERY_CSA_PROFILE + 1;   // Indexed by QueryAlgorithm
+
+struct ReplayOptions {
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    bool paced = false;
+    double speed = 1.0;
+    int repeat = 1;
+    string timetable_filename;
+};
+
+// What one replay thread measured, by algorithm
+struct ReplayThreadResult {
+    vector<vector<double>> latency_ms = vector<vector<double>>(NUM_ALGORITHMS);
+    long long skipped = 0;
+    long long sink = 0;
+};
+
+// Keeps results alive so the optimiser cannot drop the work that produced them
+static volatile long long replay_sink = 0;
+
+// Map::map_to_graph reports on cout; keep the report readable
+static bool loadQuietly(const string& nodes_filename, const string& edges_filename, Graph& graph) {
+    ostringstream discarded;
+    streambuf* saved = cout.rdbuf(discarded.rdbuf());
+    Map map(nodes_filename, edges_filename);
+    bool loaded = map.map_to_graph(graph);
+    cout.rdbuf(saved);
+    return loaded;
+}
+
+static bool isTimetableQuery(QueryAlgorithm algorithm) {
+    return algorithm == QUERY_RAPTOR || algorithm == QUERY_RAPTOR_RANGE || algorithm == QUERY_CSA || algorithm == QUERY_CSA_PROFILE;
+}
+
+// Run one query with this thread's engines; false if it cannot run against this map
+static bool runQuery(const LoggedQuery& query, const Graph& graph, const Timetable* timetable,
+                     RouteSearch& route_search, PathDetails& route, ParetoSearch& pareto, KShortestPaths& ksp, AlternativeRoutes& alternatives,
+                     IsochroneSearch& isochrone, RaptorEngine* raptor, ConnectionScanEngine* csa, long long& sink) {
+    int num_stops = isTimetableQuery(query.algorithm) ? (timetable ? timetable->numStops : 0) : graph.getNumNodes();
+    bool needs_end = query.algorithm != QUERY_ISOCHRONE;
+    if (query.start_id < 0 || query.start_id >= num_stops || (needs_end && (query.end_id < 0 || query.end_id >= num_stops))) {
+        return false;
+    }
+
+    switch (query.algorithm) {
+    case QUERY_DIJKSTRA:
+        route_search.Dijkstra(query.start_id, query.end_id, route);
+        sink += route.num_stops;
+        return true;
+    case QUERY_BFS:
+        route_search.BFS(query.start_id, query.end_id, route);
+        sink += route.num_stops;
+        return true;
+    case QUERY_PARETO:
+        sink += pareto.search(query.start_id, query.end_id).size();
+        return true;
+    case QUERY_KSP:
+        sink += ksp.search(query.start_id, query.end_id, max(1, query.param[0])).size();
+        return true;
+    case QUERY_ALTERNATIVES:
+        sink += alternatives.search(query.start_id, query.end_id, static_cast<AlternativeMethod>(query.param[0])).size();
+        return true;
+    case QUERY_ISOCHRONE:
+        sink += isochrone.search(query.start_id, QueryLog::isochroneLimits(query)).node_ids.size();
+        return true;
+    case QUERY_RAPTOR:
+        sink += raptor->earliestArrival(query.start_id, query.end_id, query.param[0], query.param[1]).arrival_time;
+        return true;
+    case QUERY_RAPTOR_RANGE:
+        sink += raptorRangeQuery(*timetable, query.start_id, query.end_id, query.param[0], query.param[1], query.param[2], 1).size();
+        return true;
+    case QUERY_CSA:
+        sink += csa->earliestArrival(query.start_id, query.end_id, query.param[0]).arrival_time;
+        return true;
+    case QUERY_CSA_PROFILE:
+        sink += csa->profile(query.start_id, query.end_id, query.param[0], query.param[1]).size();
+        return true;
+    }
+    return false;
+}
+
+// Nearest-rank percentile of sorted samples: the ceil(p * n)-th smallest, counting from 1
+static double percentile(const vector<double>& sorted, double p) {
+    // The small margin keeps products like 0.07 * 100 = 7.000000000000001 on rank 7
+    size_t nth = max<size_t>(1, static_cast<size_t>(ceil(p * sorted.size() - 1e-9)));
+    return sorted[min(nth, sorted.size()) - 1];
+}
+
+static void printRow(const string& name, vector<double> samples) {
+    if (samples.empty()) return;
+    sort(samples.begin(), samples.end());
+    double total = 0;
+    for (double sample : samples) total += sample;
+    printf("%-14s %9zu %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n", name.c_str(), samples.size(), total / samples.size(),
+           percentile(samples, 0.50), percentile(samples, 0.90), percentile(samples, 0.99), percentile(samples, 0.999),
+           samples.back());
+}
+
+int main(int argc, char* argv[]) {
+    ReplayOptions options;
+    vector<string> files;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            options.threads = static_cast<unsigned>(max(1, atoi(argv[++i])));
+        } else if (arg == "--paced") {
+            options.paced = true;
+        } else if (arg == "--speed" && i + 1 < argc) {
+            options.speed = atof(argv[++i]);
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            options.repeat = max(1, atoi(argv[++i]));
+        } else if (arg == "--timetable" && i + 1 < argc) {
+            options.timetable_filename = argv[++i];
+        } else if (arg.rfind("--", 0) == 0) {
+            files.clear();
+            break;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.size() < 2 || files.size() > 3 || options.speed <= 0) {
+        cerr << "Usage: " << argv[0] << " [--threads n] [--paced] [--speed x] [--repeat n] [--timetable file]"
+             << " <query log> (<map file> | <nodes file> <edges file>)" << endl;
+        return 1;
+    }
+
+    vector<LoggedQuery> queries;
+    if (!QueryLog::read(files[0], queries)) return 1;
+    if (queries.empty()) {
+        cerr << "Error: Query log '" << files[0] << "' has no queries." << endl;
+        return 1;
+    }
+
+    Graph graph;
+    if (!loadQuietly(files[1], files.size() == 3 ? files[2] : "", graph)) {
+        cerr << "Error: Could not load the map." << endl;
+        return 1;
+    }
+    Timetable timetable;
+    bool has_timetable = !options.timetable_filename.empty();
+    if (has_timetable && !timetable.load(options.timetable_filename, graph)) {
+        cerr << "Error: Could not load timetable '" << options.timetable_filename << "'." << endl;
+        return 1;
+    }
+
+    // Recorded offsets from the first query; repeats follow each other a millisecond apart
+    int64_t first_us = queries.front().timestamp_us;
+    int64_t span_us = max<int64_t>(0, queries.back().timestamp_us - first_us) + 1000;
+    size_t total = queries.size() * options.repeat;
+
+    vector<ReplayThreadResult> results(options.threads);
+    atomic<size_t> next_query(0);
+    auto started = chrono::steady_clock::now();
+    auto worker = [&](unsigned t) {
+        ReplayThreadResult& result = results[t];
+        RouteSearch route_search(graph);
+        PathDetails route;
+        ParetoSearch pareto(graph);
+        KShortestPaths ksp(graph, 1);
+        AlternativeRoutes alternatives(graph);
+        IsochroneSearch isochrone(graph);
+        unique_ptr<RaptorEngine> raptor(has_timetable ? new RaptorEngine(timetable) : nullptr);
+        unique_ptr<ConnectionScanEngine> csa(has_timetable ? new ConnectionScanEngine(timetable) : nullptr);
+
+        for (size_t q = next_query++; q < total; q = next_query++) {
+            const LoggedQuery& query = queries[q % queries.size()];
+            auto issued = chrono::steady_clock::now();
+            if (options.paced) {
+                int64_t offset_us = (query.timestamp_us - first_us) + static_cast<int64_t>(q / queries.size()) * span_us;
+                issued = started + chrono::microseconds(static_cast<int64_t>(offset_us / options.speed));
+                this_thread::sleep_until(issued);
+            }
+            if (!runQuery(query, graph, has_timetable ? &timetable : nullptr, route_search, route, pareto, ksp, alternatives,
+                          isochrone, raptor.get(), csa.get(), result.sink)) {
+                result.skipped++;
+                continue;
+            }
+            double latency = chrono::duration<double, milli>(chrono::steady_clock::now() - issued).count();
+            result.latency_ms[query.algorithm].push_back(latency);
+        }
+    };
+    vector<thread> pool;
+    for (unsigned t = 1; t < options.threads; t++) pool.emplace_back(worker, t);
+    worker(0);
+    for (thread& t : pool) t.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+    vector<vector<double>> by_algorithm(NUM_ALGORITHMS);
+    vector<double> all;
+    long long skipped = 0, sink = 0;
+    for (const ReplayThreadResult& result : results) {
+        for (int a = 0; a < NUM_ALGORITHMS; a++) {
+            by_algorithm[a].insert(by_algorithm[a].end(), result.latency_ms[a].begin(), result.latency_ms[a].end());
+            all.insert(all.end(), result.latency_ms[a].begin(), result.latency_ms[a].end());
+        }
+        skipped += result.skipped;
+        sink += result.sink;
+    }
+
+    printf("Replayed %zu of %zu queries (%lld skipped) on %u thread%s, %s, in %.3f s: %.1f queries/s\n", all.size(), total,
+           skipped, options.threads, options.threads == 1 ? "" : "s", options.paced ? "paced" : "maximum throughput",
+           seconds, all.size() / seconds);
+    printf("%-14s %9s %10s %10s %10s %10s %10s %10s\n", "Latency (ms)", "queries", "mean", "p50", "p90", "p99", "p99.9", "max");
+    for (int a = 0; a < NUM_ALGORITHMS; a++) {
+        printRow(queryAlgorithmName(static_cast<QueryAlgorithm>(a)), by_algorithm[a]);
+    }
+    printRow("All", all);
+    replay_sink = sink;
+    return 0;
+}
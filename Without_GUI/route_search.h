@@ -0,0 +1,150 @@
+#ifndef ROUTE_SEARCH_H
+#define ROUTE_SEARCH_H
+
+#include <algorithm>
+#include <vector>
+#include "graphV1.h"
+#include "search_workspace.h"
+
+using namespace std;
+
+// Graph::Dijkstra and Graph::BFS for batch callers: the answer goes into a PathDetails the
+// caller owns and passes back in, and the scratch space lives in the engine. The result's path
+// vector keeps its capacity between queries and the workspace keeps its arrays, heap and queue,
+// so once both have seen a query as large as the current one, or reserve() has sized them, a
+// query makes no heap allocations at all (benchmark.cpp counts them). Same answers as the Graph
+// methods, except that Dijkstra stops as soon as the destination is settled, which may pick a
+// different route among equally short ones. One engine per thread; the graph must not change
+// while it is in use.
+// Distances are kept in the graph's weight type, so on a CompactGraph the heap holds integers.
+template <class Id, class Weight>
+class BasicRouteSearch {
+private:
+    typedef BasicGraph<Id, Weight> GraphType;
+    typedef BasicSearchWorkspace<Weight> Workspace;
+
+    const GraphType& graph;
+    Workspace ws;
+    vector<int> queue;      // BFS frontier; a vector with a read index instead of a deque
+
+    // Reset result to "no path" without giving up the path's capacity
+    static void clear(PathDetails& result) {
+        result.total_weight = DOUBLE_INF;
+        result.num_stops = -1;
+        result.node_ids_in_path.clear();
+        result.path_exists = false;
+        result.stats = SearchStats();
+    }
+
+    bool validIds(int startNodeId, int endNodeId, const char* algorithm) const {
+        int numNodes = graph.getNumNodes();
+        if (startNodeId >= numNodes || endNodeId >= numNodes || startNodeId < 0 || endNodeId < 0) {
+            cerr << "Error: Invalid start or end node ID in " << algorithm << "." << endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Walk the parents back from the end, then reverse in place
+    void writePath(int endNodeId, PathDetails& result) const {
+        for (int v = endNodeId; v != -1; v = ws.previous(v)) result.node_ids_in_path.push_back(v);
+        reverse(result.node_ids_in_path.begin(), result.node_ids_in_path.end());
+        result.num_stops = static_cast<int>(result.node_ids_in_path.size()) - 1;
+        result.path_exists = true;
+    }
+
+public:
+    BasicRouteSearch(const GraphType& g) : graph(g) {}
+
+    // Size the workspace, the BFS queue and result's path for the whole graph up front. Only
+    // Dijkstra's heap, which can briefly hold a stop more than once, may still grow afterwards.
+    void reserve(PathDetails& result) {
+        int numNodes = graph.getNumNodes();
+        ws.prepare(numNodes);
+        ws.heap.reserve(numNodes);
+        queue.reserve(numNodes);
+        result.node_ids_in_path.reserve(numNodes);
+    }
+
+    template <class Stats = NoSearchStats>
+    bool Dijkstra(int startNodeId, int endNodeId, PathDetails& result) {
+        TraceSpan span("Dijkstra (reused buffers)", "search");
+        Stats counters;
+        clear(result);
+        if (!validIds(startNodeId, endNodeId, "Dijkstra")) return false;
+
+        ws.prepare(graph.getNumNodes());
+        ws.update(startNodeId, Weight(0), -1);
+        ws.push(Weight(0), startNodeId);
+        counters.pushed(ws.heap.size());
+        while (!ws.heap.empty()) {
+            typename Workspace::HeapEntry top = ws.pop();
+            counters.popped();
+            int u = top.second;
+            if (ws.isSettled(u)) {
+                counters.stale(); // Settled already through a shorter entry
+                continue;
+            }
+            ws.settle(u);
+            counters.settled();
+            if (u == endNodeId) break;
+            for (const typename GraphType::EdgeType& edge : graph.edgesOf(u)) {
+                counters.relaxed();
+                int v = edge.destination_node_id;
+                if (ws.isSettled(v)) continue;
+                Weight d = top.first + edge.weight;
+                if (d < ws.distance(v)) {
+                    ws.update(v, d, u);
+                    ws.push(d, v);
+                    counters.pushed(ws.heap.size());
+                }
+            }
+        }
+        if (ws.isSettled(endNodeId)) {
+            result.total_weight = ws.distance(endNodeId);
+            writePath(endNodeId, result);
+        }
+        counters.finish(result.stats);
+        return result.path_exists;
+    }
+
+    // Like Graph::BFS, total_weight is only set when start and end are the same stop
+    template <class Stats = NoSearchStats>
+    bool BFS(int startNodeId, int endNodeId, PathDetails& result) {
+        TraceSpan span("BFS (reused buffers)", "search");
+        Stats counters;
+        clear(result);
+        if (!validIds(startNodeId, endNodeId, "BFS")) return false;
+
+        ws.prepare(graph.getNumNodes());
+        queue.clear();
+        ws.update(startNodeId, Weight(0), -1);
+        queue.push_back(startNodeId);
+        counters.pushed(queue.size());
+        for (size_t head = 0; head < queue.size(); head++) {
+            int u = queue[head];
+            counters.popped();
+            counters.settled();
+            if (u == endNodeId) break;
+            for (const typename GraphType::EdgeType& edge : graph.edgesOf(u)) {
+                counters.relaxed();
+                int v = edge.destination_node_id;
+                if (ws.distance(v) == unreachableWeight<Weight>()) {
+                    ws.update(v, ws.distance(u) + 1, u);
+                    queue.push_back(v);
+                    counters.pushed(queue.size() - head - 1);
+                }
+            }
+        }
+        if (ws.distance(endNodeId) != unreachableWeight<Weight>()) {
+            writePath(endNodeId, result);
+            if (startNodeId == endNodeId) result.total_weight = 0.0;
+        }
+        counters.finish(result.stats);
+        return result.path_exists;
+    }
+};
+
+typedef BasicRouteSearch<int, double> RouteSearch;
+
+#endif // ROUTE_SEARCH_H
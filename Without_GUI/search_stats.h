@@ -0,0 +1,135 @@
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <sstream>
+#include <string>
+#include "perf_counters.h"
+
+using namespace std;
+
+// What one query did: how much of the graph it touched and how long it took.
+// Timetable engines count stop labels improved as settled and connections, trip stops and
+// footpaths scanned as relaxed; RAPTOR's queue is the routes queued for a round, CSA has none.
+struct SearchStats {
+    bool collected = false;         // False when the search ran without instrumentation
+    long long nodes_settled = 0;
+    long long edges_relaxed = 0;    // Edges looked at from settled nodes
+    long long heap_pushes = 0;
+    long long heap_pops = 0;
+    long long stale_pops = 0;       // Pops of nodes already settled through a better entry
+    size_t peak_queue = 0;
+    double wall_ms = 0;
+    double cpu_ms = 0;              // CPU time of the threads that did the work
+    HardwareCounts hardware;        // Only with PerfSearchStats on a machine that has counters
+
+    // Add another part of the same query, e.g. a worker thread's share
+    void merge(const SearchStats& other) {
+        if (!other.collected) return;
+        collected = true;
+        nodes_settled += other.nodes_settled;
+        edges_relaxed += other.edges_relaxed;
+        heap_pushes += other.heap_pushes;
+        heap_pops += other.heap_pops;
+        stale_pops += other.stale_pops;
+        if (other.peak_queue > peak_queue) peak_queue = other.peak_queue;
+        cpu_ms += other.cpu_ms;
+        hardware.add(other.hardware);
+    }
+
+    // One line for the frontends
+    string summary() const {
+        ostringstream out;
+        out << nodes_settled << " settled, " << edges_relaxed << " edges relaxed, "
+            << heap_pushes << " pushes, " << heap_pops << " pops (" << stale_pops << " stale), peak queue "
+            << peak_queue << ", " << wall_ms << " ms wall, " << cpu_ms << " ms CPU";
+        if (hardware.measured) out << ", " << hardware.summary();
+        return out.str();
+    }
+};
+
+// Compile-time policies for the search engines. Every engine takes one as a template parameter,
+// defaulting to NoSearchStats, whose hooks are empty and compile away entirely; pass
+// CountSearchStats to fill in SearchStats at the price of a few increments per edge, or
+// PerfSearchStats to add the hardware counters of the searching threads as well.
+struct NoSearchStats {
+    static const bool enabled = false;
+
+    void settled() {}
+    void relaxed() {}
+    void pushed(size_t) {}
+    void popped() {}
+    void stale() {}
+    void finish(SearchStats&) {}
+};
+
+class CountSearchStats {
+private:
+    SearchStats stats;
+    chrono::steady_clock::time_point wall_start;
+    double cpu_start;
+
+    static double threadCpuMs() {
+        timespec now;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        return now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+    }
+
+public:
+    static const bool enabled = true;
+
+    // Starts the clocks
+    CountSearchStats() : wall_start(chrono::steady_clock::now()), cpu_start(threadCpuMs()) {
+        stats.collected = true;
+    }
+
+    void settled() { stats.nodes_settled++; }
+    void relaxed() { stats.edges_relaxed++; }
+    void pushed(size_t queue_size) {
+        stats.heap_pushes++;
+        if (queue_size > stats.peak_queue) stats.peak_queue = queue_size;
+    }
+    void popped() { stats.heap_pops++; }
+    void stale() { stats.stale_pops++; }
+
+    // Stop the clocks and add everything counted to out
+    void finish(SearchStats& out) {
+        stats.wall_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - wall_start).count();
+        stats.cpu_ms = threadCpuMs() - cpu_start;
+        double wall_ms = max(out.wall_ms, stats.wall_ms);
+        out.merge(stats);
+        out.wall_ms = wall_ms;
+    }
+};
+
+// CountSearchStats plus cycles, instructions, cache and branch misses from perf_counters.h.
+// Where counters are unavailable the hardware counts stay unmeasured and the rest still works.
+class PerfSearchStats : public CountSearchStats {
+private:
+    PerfCounters& counters;
+    bool counting = true;
+
+public:
+    PerfSearchStats() : counters(PerfCounters::forThisThread()) { counters.start(); }
+
+    // A search abandoned by an exception never calls finish(); stop the counters anyway so the
+    // thread's next search still starts them
+    ~PerfSearchStats() {
+        if (counting) counters.stop();
+    }
+
+    PerfSearchStats(const PerfSearchStats&) = delete;
+    PerfSearchStats& operator=(const PerfSearchStats&) = delete;
+
+    void finish(SearchStats& out) {
+        counting = false;
+        HardwareCounts counted = counters.stop();
+        CountSearchStats::finish(out);
+        out.hardware.add(counted);
+    }
+};
+
+#endif // SEARCH_STATS_H
@@ -0,0 +1,565 @@
+// Long-running query server: loads the map once and answers route queries over a socket.
+//
+// Build: g++ -std=c++17 -O2 -pthread server.cpp -o commute_server
+// Run:   ./commute_server nodes.txt edges.txt --unix /tmp/commute.sock
+//        ./commute_server Summer_Routes.txt --port 7070 --threads 4
+//
+// Protocol: one query per line, one answer line per query, answered in the order asked.
+//   DIJKSTRA <start> [destination]      fastest route
+//   BFS <start> [destination]           fewest stops
+//   PARETO <start> [destination]        every time/stops trade-off
+//   KSP <k> <start> [destination]       k backup routes
+//   ADDSTOP <name>                      add a stop (kept in memory only)
+//   ADDROUTE <a> <b> <weight>           add a road between two existing stops (kept in memory only)
+//   PING                                liveness check
+//   QUIT                                close this connection
+// The destination defaults to the university. A route is answered as
+//   OK <total_weight> <num_stops> <stop> <stop> ...
+// several routes are separated by " | ", and failures start with ERR.
+//
+// Set COMMUTE_TRACE=trace.json to record load, query and edit spans (trace.h); the file is
+// written at shutdown and opens in chrome://tracing or ui.perfetto.dev.
+//
+// Queries run on immutable graph snapshots (snapshot.h). Edits are batched by the event loop
+// into the next snapshot, so a query never sees a half-applied edit and never waits for one.
+// An edit is checked when it is read, against the latest snapshot plus the edits still waiting,
+// and answered "OK QUEUED" only if it will apply; otherwise it gets ERR and changes nothing.
+// Read-your-writes: a connection's queries sent after its own accepted edit see that edit. Other
+// connections see it once the batch is published, at the latest after the current round of
+// socket events.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "graphV1.h"
+#include "map.h"
+#include "pareto.h"
+#include "ksp.h"
+#include "route_search.h"
+#include "snapshot.h"
+
+using namespace std;
+
+const int UNIVERSITY_NODE_ID = 0;
+const size_t MAX_LINE_LENGTH = 4096;
+
+// A query waiting for a worker, and the worker's answer travelling back to the event loop
+struct Job {
+    unsigned long long connection_id;
+    unsigned long long sequence;    // Position of the query on its connection
+    string query;
+    string answer;
+};
+
+struct Connection {
+    int fd;
+    string in_buffer;
+    string out_buffer;
+    unsigned long long next_sequence = 0;     // Assigned to the next query read
+    unsigned long long next_to_send = 0;      // Answers are written strictly in this order
+    map<unsigned long long, string> finished; // Answers that overtook an earlier query
+    bool closing = false;
+    bool edited = false;                      // Sent an edit that may not be published yet
+};
+
+atomic<bool> stop_requested(false);
+int wake_fd = -1;
+
+void handleStopSignal(int) {
+    stop_requested = true;
+    unsigned long long one = 1;
+    ssize_t ignored = write(wake_fd, &one, sizeof(one)); // async-signal-safe wake-up of epoll_wait
+    (void)ignored;
+}
+
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+string formatRoute(const PathDetails& path, const Graph& graph) {
+    ostringstream oss;
+    oss << "OK ";
+    if (path.total_weight == DOUBLE_INF) {
+        oss << "-"; // BFS counts stops only
+    } else {
+        oss << path.total_weight;
+    }
+    oss << " " << path.num_stops;
+    for (int node_id : path.node_ids_in_path) {
+        oss << " " << graph.getNodeName(node_id);
+    }
+    return oss.str();
+}
+
+// Runs queries on the latest graph snapshot. Each worker owns its own engines and rebuilds
+// them only when a new snapshot has been published.
+class QueryWorker {
+private:
+    GraphStore& store;
+    unsigned long long bound_version = 0;  // Snapshot the engines were built for; 0 = none yet
+    unique_ptr<RouteSearch> route_search;
+    PathDetails route;                      // Reused by every DIJKSTRA and BFS query
+    unique_ptr<ParetoSearch> pareto;
+    unique_ptr<KShortestPaths> ksp;
+
+public:
+    QueryWorker(GraphStore& s) : store(s) {}
+
+    string answer(const string& query) {
+        istringstream iss(query);
+        string algorithm;
+        if (!(iss >> algorithm)) return "ERR empty query";
+        for (char& c : algorithm) c = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+
+        if (algorithm == "PING") return "OK PONG";
+
+        // Pin one consistent version for the whole query
+        GraphStore::ReadGuard snapshot = store.read();
+        const Graph& graph = *snapshot;
+        if (snapshot.version() != bound_version) {
+            bound_version = snapshot.version();
+            route_search.reset(new RouteSearch(graph));
+            pareto.reset(new ParetoSearch(graph));
+            ksp.reset(new KShortestPaths(graph, 1));
+        }
+
+        int k = 1;
+        if (algorithm == "KSP" && (!(iss >> k) || k < 1)) return "ERR KSP needs a positive route count";
+
+        string start_name, dest_name;
+        if (!(iss >> start_name)) return "ERR missing start location";
+        int start_id = graph.getNodeIndexByname(start_name);
+        if (start_id == -1) return "ERR start location '" + start_name + "' not found";
+        int dest_id = UNIVERSITY_NODE_ID;
+        if (iss >> dest_name) {
+            dest_id = graph.getNodeIndexByname(dest_name);
+            if (dest_id == -1) return "ERR destination '" + dest_name + "' not found";
+        }
+
+        if (algorithm == "DIJKSTRA" || algorithm == "BFS") {
+            bool found = algorithm == "DIJKSTRA" ? route_search->Dijkstra(start_id, dest_id, route)
+                                                 : route_search->BFS(start_id, dest_id, route);
+            return found ? formatRoute(route, graph) : "ERR no path found";
+        }
+
+        vector<PathDetails> routes;
+        if (algorithm == "PARETO") {
+            routes = pareto->search(start_id, dest_id);
+        } else if (algorithm == "KSP") {
+            routes = ksp->search(start_id, dest_id, k);
+        } else {
+            return "ERR unknown algorithm '" + algorithm + "'";
+        }
+
+        if (routes.empty() || !routes.front().path_exists) return "ERR no path found";
+        string line;
+        for (size_t i = 0; i < routes.size(); i++) {
+            if (i > 0) line += " | ";
+            line += formatRoute(routes[i], graph);
+        }
+        return line;
+    }
+};
+
+// ADDSTOP and ADDROUTE, checked and queued by the event loop. The loop is the only writer, so the
+// latest snapshot plus the stops added in the waiting batch is exactly what the edits will meet
+// at publish(), and an edit accepted here is sure to apply.
+class EditBatch {
+private:
+    GraphStore& store;
+    unordered_set<string> new_stops;    // Added by queued edits, not published yet
+
+    bool exists(const Graph& graph, const string& name) const {
+        return graph.getNodeIndexByname(name) != -1 || new_stops.count(name) > 0;
+    }
+
+public:
+    EditBatch(GraphStore& s) : store(s) {}
+
+    static bool isEdit(const string& algorithm) { return algorithm == "ADDSTOP" || algorithm == "ADDROUTE"; }
+
+    // Queue the edit and answer OK QUEUED, or answer ERR and leave the batch unchanged
+    string queue(const string& algorithm, istringstream& iss) {
+        GraphStore::ReadGuard snapshot = store.read();
+        const Graph& graph = *snapshot;
+        if (algorithm == "ADDSTOP") {
+            string name;
+            if (!(iss >> name)) return "ERR missing stop name";
+            if (exists(graph, name)) return "ERR stop '" + name + "' already exists";
+            new_stops.insert(name);
+            store.queueEdit([name](Graph& next) { next.addNode(next.getNumNodes(), name); });
+            return "OK QUEUED";
+        }
+
+        string source_name, dest_name;
+        double weight;
+        if (!(iss >> source_name >> dest_name >> weight) || weight < 0) return "ERR usage: ADDROUTE <a> <b> <weight>";
+        if (!exists(graph, source_name)) return "ERR stop '" + source_name + "' not found";
+        if (!exists(graph, dest_name)) return "ERR stop '" + dest_name + "' not found";
+        if (source_name == dest_name) return "ERR cannot add a road from a stop to itself";
+        // Resolved when the batch is applied, so stops added earlier in the same batch work too
+        store.queueEdit([source_name, dest_name, weight](Graph& next) {
+            next.addEdge(next.getNodeIndexByname(source_name), next.getNodeIndexByname(dest_name), weight);
+        });
+        return "OK QUEUED";
+    }
+
+    // Everything queued since the last publish goes out as one new version
+    void publish() {
+        if (store.hasPendingEdits()) store.publish();
+        new_stops.clear();
+    }
+};
+
+// Fixed pool of workers fed from one queue. Finished jobs are handed back to the event loop
+// through a second queue, and the eventfd wakes epoll_wait up to collect them.
+class WorkerPool {
+private:
+    mutex queue_mutex;
+    condition_variable queue_ready;
+    deque<Job> pending;
+    mutex done_mutex;
+    vector<Job> done;
+    vector<thread> threads;
+    bool shutting_down = false;
+
+public:
+    WorkerPool(GraphStore& store, unsigned count) {
+        for (unsigned i = 0; i < count; i++) {
+            threads.emplace_back([this, &store]() {
+                Tracer::setThreadName("query worker");
+                QueryWorker worker(store);
+                while (true) {
+                    Job job;
+                    {
+                        unique_lock<mutex> lock(queue_mutex);
+                        queue_ready.wait(lock, [this]() { return shutting_down || !pending.empty(); });
+                        if (pending.empty()) return;
+                        job = move(pending.front());
+                        pending.pop_front();
+                    }
+                    job.answer = worker.answer(job.query);
+                    {
+                        lock_guard<mutex> lock(done_mutex);
+                        done.push_back(move(job));
+                    }
+                    unsigned long long one = 1;
+                    ssize_t ignored = write(wake_fd, &one, sizeof(one));
+                    (void)ignored;
+                }
+            });
+        }
+    }
+
+    void submit(Job job) {
+        {
+            lock_guard<mutex> lock(queue_mutex);
+            pending.push_back(move(job));
+        }
+        queue_ready.notify_one();
+    }
+
+    vector<Job> collect() {
+        lock_guard<mutex> lock(done_mutex);
+        vector<Job> finished;
+        finished.swap(done);
+        return finished;
+    }
+
+    ~WorkerPool() {
+        {
+            lock_guard<mutex> lock(queue_mutex);
+            shutting_down = true;
+        }
+        queue_ready.notify_all();
+        for (thread& t : threads) t.join();
+    }
+};
+
+int openListener(const string& unix_path, int port) {
+    int fd;
+    if (!unix_path.empty()) {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (unix_path.size() >= sizeof(address.sun_path)) {
+            cerr << "Error: Socket path '" << unix_path << "' is too long." << endl;
+            return -1;
+        }
+        strcpy(address.sun_path, unix_path.c_str());
+        unlink(unix_path.c_str()); // Left over from a previous run
+        if (fd == -1 || bind(fd, (sockaddr*)&address, sizeof(address)) == -1) {
+            cerr << "Error: Could not bind '" << unix_path << "': " << strerror(errno) << endl;
+            return -1;
+        }
+    } else {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Local clients only
+        address.sin_port = htons(static_cast<unsigned short>(port));
+        if (fd == -1 || bind(fd, (sockaddr*)&address, sizeof(address)) == -1) {
+            cerr << "Error: Could not bind 127.0.0.1:" << port << ": " << strerror(errno) << endl;
+            return -1;
+        }
+    }
+    if (listen(fd, SOMAXCONN) == -1 || !setNonBlocking(fd)) {
+        cerr << "Error: Could not listen: " << strerror(errno) << endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// File the answer to query number sequence and move every answer now in order to the output
+void queueAnswer(Connection& connection, unsigned long long sequence, string answer) {
+    connection.finished[sequence] = move(answer);
+    while (!connection.finished.empty() && connection.finished.begin()->first == connection.next_to_send) {
+        connection.out_buffer += connection.finished.begin()->second + "\n";
+        connection.finished.erase(connection.finished.begin());
+        connection.next_to_send++;
+    }
+}
+
+// Flush as much of the connection's output as the socket takes; watch EPOLLOUT only while data remains
+void flushConnection(int epoll_fd, Connection& connection) {
+    while (!connection.out_buffer.empty()) {
+        ssize_t written = send(connection.fd, connection.out_buffer.data(), connection.out_buffer.size(), MSG_NOSIGNAL);
+        if (written > 0) {
+            connection.out_buffer.erase(0, written);
+        } else if (written == -1 && errno == EINTR) {
+            continue;
+        } else {
+            break; // EAGAIN: wait for EPOLLOUT. Other errors surface as EPOLLERR/EPOLLHUP.
+        }
+    }
+    epoll_event event;
+    event.events = EPOLLIN | EPOLLRDHUP | (connection.out_buffer.empty() ? 0u : static_cast<unsigned>(EPOLLOUT));
+    event.data.fd = connection.fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, connection.fd, &event);
+}
+
+int main(int argc, char* argv[]) {
+    string nodes_filename, edges_filename, unix_path;
+    int port = -1;
+    unsigned num_threads = max(1u, thread::hardware_concurrency());
+    Tracer::startFromEnvironment();
+    Tracer::setThreadName("event loop");
+
+    vector<string> files;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--unix" && i + 1 < argc) {
+            unix_path = argv[++i];
+        } else if (arg == "--port" && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            num_threads = max(1, atoi(argv[++i]));
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (files.empty() || files.size() > 2 || (unix_path.empty() && port <= 0)) {
+        cerr << "Usage: " << argv[0] << " <nodes file> [edges file] (--unix <path> | --port <n>) [--threads <n>]" << endl;
+        return 1;
+    }
+    nodes_filename = files[0];
+    if (files.size() == 2) edges_filename = files[1];
+
+    Graph bus_network;
+    Map map1(nodes_filename, edges_filename);
+    if (!map1.map_to_graph(bus_network)) {
+        cerr << "Failed to load map. Exiting." << endl;
+        return 1;
+    }
+
+    int listen_fd = openListener(unix_path, port);
+    if (listen_fd == -1) return 1;
+
+    wake_fd = eventfd(0, EFD_NONBLOCK);
+    int epoll_fd = epoll_create1(0);
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = listen_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event);
+    event.data.fd = wake_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+
+    signal(SIGINT, handleStopSignal);
+    signal(SIGTERM, handleStopSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    int num_stops = bus_network.getNumNodes();
+    GraphStore store(move(bus_network));
+    WorkerPool pool(store, num_threads);
+    EditBatch edits(store);
+    unordered_map<int, Connection> connections;               // by socket
+    unordered_map<unsigned long long, int> connection_sockets; // connection id -> socket
+    unordered_map<int, unsigned long long> socket_connections;
+    unsigned long long next_connection_id = 0;
+
+    cout << "Serving " << num_stops << " stops on "
+         << (unix_path.empty() ? "127.0.0.1:" + to_string(port) : unix_path)
+         << " with " << num_threads << " workers." << endl;
+
+    auto closeConnection = [&](int fd) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        connection_sockets.erase(socket_connections[fd]);
+        socket_connections.erase(fd);
+        connections.erase(fd);
+    };
+
+    const int MAX_EVENTS = 64;
+    epoll_event events[MAX_EVENTS];
+    while (!stop_requested) {
+        int ready = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (ready == -1) {
+            if (errno == EINTR) continue;
+            cerr << "Error: epoll_wait failed: " << strerror(errno) << endl;
+            break;
+        }
+
+        for (int e = 0; e < ready; e++) {
+            int fd = events[e].data.fd;
+
+            if (fd == listen_fd) {
+                int client;
+                while ((client = accept(listen_fd, nullptr, nullptr)) != -1) {
+                    setNonBlocking(client);
+                    if (unix_path.empty()) {
+                        int nodelay = 1;
+                        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+                    }
+                    Connection connection;
+                    connection.fd = client;
+                    connections[client] = connection;
+                    connection_sockets[next_connection_id] = client;
+                    socket_connections[client] = next_connection_id++;
+                    epoll_event client_event;
+                    client_event.events = EPOLLIN | EPOLLRDHUP;
+                    client_event.data.fd = client;
+                    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client, &client_event);
+                }
+                continue;
+            }
+
+            if (fd == wake_fd) {
+                unsigned long long count;
+                ssize_t ignored = read(wake_fd, &count, sizeof(count));
+                (void)ignored;
+                for (Job& job : pool.collect()) {
+                    auto socket = connection_sockets.find(job.connection_id);
+                    if (socket == connection_sockets.end()) continue; // Client left meanwhile
+                    Connection& connection = connections[socket->second];
+                    queueAnswer(connection, job.sequence, move(job.answer));
+                    flushConnection(epoll_fd, connection);
+                    if (connection.closing && connection.out_buffer.empty() && connection.next_to_send == connection.next_sequence) {
+                        closeConnection(connection.fd);
+                    }
+                }
+                continue;
+            }
+
+            auto found = connections.find(fd);
+            if (found == connections.end()) continue;
+            Connection& connection = found->second;
+
+            if (events[e].events & EPOLLOUT) {
+                flushConnection(epoll_fd, connection);
+            }
+
+            if (events[e].events & EPOLLIN) {
+                char buffer[4096];
+                ssize_t received;
+                while ((received = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+                    connection.in_buffer.append(buffer, received);
+                }
+                if (received == 0) connection.closing = true;
+
+                size_t newline;
+                while ((newline = connection.in_buffer.find('\n')) != string::npos) {
+                    string line = connection.in_buffer.substr(0, newline);
+                    connection.in_buffer.erase(0, newline + 1);
+                    if (!line.empty() && line.back() == '\r') line.pop_back();
+                    if (line.empty()) continue;
+                    if (line == "QUIT" || line == "quit") {
+                        connection.closing = true;
+                        connection.in_buffer.clear();
+                        break;
+                    }
+                    istringstream iss(line);
+                    string algorithm;
+                    iss >> algorithm;
+                    for (char& c : algorithm) c = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+                    if (EditBatch::isEdit(algorithm)) {
+                        string answer = edits.queue(algorithm, iss);
+                        if (answer.compare(0, 2, "OK") == 0) connection.edited = true;
+                        queueAnswer(connection, connection.next_sequence++, answer);
+                        continue;
+                    }
+                    // Read-your-writes: the query must run on a version holding this connection's edits
+                    if (connection.edited) {
+                        edits.publish();
+                        connection.edited = false;
+                    }
+                    Job job;
+                    job.connection_id = socket_connections[fd];
+                    job.sequence = connection.next_sequence++;
+                    job.query = line;
+                    pool.submit(move(job));
+                }
+                flushConnection(epoll_fd, connection);
+                if (connection.in_buffer.size() > MAX_LINE_LENGTH) {
+                    // Takes its turn after the answers still owed for earlier queries
+                    queueAnswer(connection, connection.next_sequence++, "ERR query too long");
+                    flushConnection(epoll_fd, connection);
+                    connection.closing = true;
+                    connection.in_buffer.clear();
+                }
+            }
+
+            if (events[e].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(fd);
+            } else if (connection.closing && connection.out_buffer.empty() &&
+                       connection.next_to_send == connection.next_sequence) {
+                closeConnection(fd);
+            }
+        }
+        // Edits accepted this round become visible to every connection
+        edits.publish();
+    }
+
+    cout << "Shutting down." << endl;
+    for (auto& entry : connections) close(entry.first);
+    close(listen_fd);
+    if (!unix_path.empty()) unlink(unix_path.c_str());
+    Tracer::finish();
+    return 0;
+}
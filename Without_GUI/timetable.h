@@ -0,0 +1,271 @@
+#ifndef TIMETABLE_H
+#define TIMETABLE_H
+
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <limits>
+#include "graphV1.h"
+
+using namespace std;
+
+// Times are whole minutes after midnight
+const int TIME_INF = numeric_limits<int>::max();
+
+// Parse "HH:MM" into minutes after midnight, -1 if malformed
+int parseClockTime(string const& text) {
+    size_t colon = text.find(':');
+    if (colon == string::npos || colon == 0 || colon + 1 >= text.size()) {
+        return -1;
+    }
+    // Digits by hand: hours past MAX_HOURS (a hundred years) are malformed rather than an
+    // overflow, and leave plenty of room below TIME_INF for the travel times added to them
+    const int MAX_HOURS = 24 * 365 * 100;
+    int hours = 0, minutes = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (i == colon) continue;
+        if (text[i] < '0' || text[i] > '9') return -1;
+        if (i < colon) {
+            hours = hours * 10 + (text[i] - '0');
+            if (hours > MAX_HOURS) return -1;
+        } else {
+            minutes = minutes * 10 + (text[i] - '0');
+            if (minutes >= 60) return -1;
+        }
+    }
+    return hours * 60 + minutes;
+}
+
+string formatClockTime(int time) {
+    if (time == TIME_INF || time < 0) return "--:--";
+    ostringstream oss;
+    oss << setw(2) << setfill('0') << time / 60 << ":" << setw(2) << setfill('0') << time % 60;
+    return oss.str();
+}
+
+// Walking transfer between two stops
+struct Footpath {
+    int destination_stop_id;
+    int duration;
+
+    Footpath(int dest_id, int d) : destination_stop_id(dest_id), duration(d) {}
+};
+
+// One ride on a bus (or a walk) inside a journey
+struct JourneyLeg {
+    int route_id = -1;          // -1 for a footpath
+    int board_stop_id = -1;
+    int board_time = TIME_INF;
+    int alight_stop_id = -1;
+    int alight_time = TIME_INF;
+};
+
+// Struct to hold timetable query results
+struct Journey {
+    bool journey_exists = false;
+    int departure_time = TIME_INF;   // Time the traveller leaves the start stop
+    int arrival_time = TIME_INF;
+    int num_transfers = -1;
+    vector<JourneyLeg> legs;
+    vector<int> node_ids_in_path;    // Every stop passed, for display like PathDetails
+    SearchStats stats;               // Filled when the query ran with CountSearchStats
+
+    Journey() = default;
+};
+
+// Scheduled service loaded from a timetable file.
+// Every array is flat so that engines walk memory in order:
+//   route r serves route_stops[route_stop_offset[r] .. route_stop_offset[r + 1])
+//   its trips are stored trip-major in stop_times starting at route_time_offset[r],
+//   so the time of trip t at the i-th stop of r is stop_times[route_time_offset[r] + t * length + i]
+//   stop s is served by stop_routes[stop_route_offset[s] .. stop_route_offset[s + 1])
+// Trips of a route are sorted by departure and never overtake each other.
+class Timetable {
+public:
+    struct RouteStop {
+        int route_id;
+        int stop_index; // Position of the stop along the route
+    };
+
+    vector<string> route_names;
+    vector<int> route_stop_offset;
+    vector<int> route_num_trips;
+    vector<int> route_time_offset;
+    vector<int> route_stops;
+    vector<int> stop_times;
+
+    vector<int> stop_route_offset;
+    vector<RouteStop> stop_routes;
+
+    vector<int> footpath_offset;
+    vector<Footpath> footpaths;
+
+    int numStops = 0;
+
+    int getNumRoutes() const { return static_cast<int>(route_names.size()); }
+    int getRouteLength(int route_id) const { return route_stop_offset[route_id + 1] - route_stop_offset[route_id]; }
+    int getNumTrips(int route_id) const { return route_num_trips[route_id]; }
+    int getRouteStop(int route_id, int stop_index) const { return route_stops[route_stop_offset[route_id] + stop_index]; }
+
+    int getTripTime(int route_id, int trip, int stop_index) const {
+        return stop_times[route_time_offset[route_id] + trip * getRouteLength(route_id) + stop_index];
+    }
+
+    int getNumTrips() const {
+        int total = 0;
+        for (int trips : route_num_trips) total += trips;
+        return total;
+    }
+
+    // Load routes, trips and footpaths. Stop IDs must exist in the graph the timetable belongs to.
+    bool load(string const& filename, const Graph& graph) {
+        TraceSpan span("load timetable", "load");
+        ifstream file(filename);
+        if (!file.is_open()) {
+            cerr << "Error: Could not open timetable file '" << filename << "'" << endl;
+            return false;
+        }
+
+        numStops = graph.getNumNodes();
+
+        struct PendingRoute {
+            string name;
+            vector<int> stops;
+            vector<vector<int>> trips;
+        };
+        vector<PendingRoute> pending;
+        vector<vector<Footpath>> walks(numStops);
+
+        string line;
+        int line_number = 0;
+        while (getline(file, line)) {
+            line_number++;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            istringstream iss(line);
+            string keyword;
+            if (!(iss >> keyword) || keyword[0] == '#') continue;
+
+            if (keyword == "ROUTE") {
+                PendingRoute route;
+                if (!(iss >> route.name)) {
+                    cerr << "Error: ROUTE without a name in timetable line " << line_number << endl;
+                    return false;
+                }
+                pending.push_back(route);
+            } else if (keyword == "STOPS") {
+                if (pending.empty() || !pending.back().stops.empty()) {
+                    cerr << "Error: STOPS must follow a ROUTE line (timetable line " << line_number << ")" << endl;
+                    return false;
+                }
+                int stop_id;
+                while (iss >> stop_id) {
+                    if (stop_id < 0 || stop_id >= numStops) {
+                        cerr << "Error: Unknown stop ID " << stop_id << " in timetable line " << line_number << endl;
+                        return false;
+                    }
+                    pending.back().stops.push_back(stop_id);
+                }
+                if (pending.back().stops.size() < 2) {
+                    cerr << "Error: A route needs at least two stops (timetable line " << line_number << ")" << endl;
+                    return false;
+                }
+            } else if (keyword == "TRIP") {
+                if (pending.empty() || pending.back().stops.empty()) {
+                    cerr << "Error: TRIP must follow a STOPS line (timetable line " << line_number << ")" << endl;
+                    return false;
+                }
+                vector<int> times;
+                string token;
+                while (iss >> token) {
+                    int time = parseClockTime(token);
+                    if (time < 0 || (!times.empty() && time < times.back())) {
+                        cerr << "Error: Invalid or decreasing time '" << token << "' in timetable line " << line_number << endl;
+                        return false;
+                    }
+                    times.push_back(time);
+                }
+                if (times.size() != pending.back().stops.size()) {
+                    cerr << "Error: TRIP has " << times.size() << " times but the route has "
+                         << pending.back().stops.size() << " stops (timetable line " << line_number << ")" << endl;
+                    return false;
+                }
+                pending.back().trips.push_back(times);
+            } else if (keyword == "FOOTPATH") {
+                int a, b, duration;
+                if (!(iss >> a >> b >> duration) || a < 0 || b < 0 || a >= numStops || b >= numStops || duration < 0) {
+                    cerr << "Error: Invalid FOOTPATH in timetable line " << line_number << endl;
+                    return false;
+                }
+                walks[a].push_back(Footpath(b, duration));
+                walks[b].push_back(Footpath(a, duration)); // Walking is undirected like the road graph
+            } else {
+                cerr << "Error: Unknown keyword '" << keyword << "' in timetable line " << line_number << endl;
+                return false;
+            }
+        }
+        file.close();
+
+        // --- Flatten into the contiguous route/stop arrays ---
+        route_names.clear();
+        route_stop_offset.assign(1, 0);
+        route_num_trips.clear();
+        route_time_offset.clear();
+        route_stops.clear();
+        stop_times.clear();
+
+        for (PendingRoute& route : pending) {
+            if (route.trips.empty()) continue; // A route without trips can never be boarded
+
+            sort(route.trips.begin(), route.trips.end());
+            int length = static_cast<int>(route.stops.size());
+            for (size_t t = 1; t < route.trips.size(); t++) {
+                for (int i = 0; i < length; i++) {
+                    if (route.trips[t][i] < route.trips[t - 1][i]) {
+                        cerr << "Error: Trips of route '" << route.name << "' overtake each other; split them into separate routes." << endl;
+                        return false;
+                    }
+                }
+            }
+
+            route_names.push_back(route.name);
+            route_stops.insert(route_stops.end(), route.stops.begin(), route.stops.end());
+            route_stop_offset.push_back(static_cast<int>(route_stops.size()));
+            route_num_trips.push_back(static_cast<int>(route.trips.size()));
+            route_time_offset.push_back(static_cast<int>(stop_times.size()));
+            for (const vector<int>& trip : route.trips) {
+                stop_times.insert(stop_times.end(), trip.begin(), trip.end());
+            }
+        }
+
+        // Stop -> routes serving it, counted first so it is filled in place
+        stop_route_offset.assign(numStops + 1, 0);
+        for (int s : route_stops) stop_route_offset[s + 1]++;
+        for (int s = 0; s < numStops; s++) stop_route_offset[s + 1] += stop_route_offset[s];
+        stop_routes.assign(route_stops.size(), RouteStop());
+        vector<int> fill(stop_route_offset.begin(), stop_route_offset.end() - 1);
+        for (int r = 0; r < getNumRoutes(); r++) {
+            for (int i = 0; i < getRouteLength(r); i++) {
+                int s = getRouteStop(r, i);
+                stop_routes[fill[s]++] = RouteStop{r, i};
+            }
+        }
+
+        footpath_offset.assign(numStops + 1, 0);
+        footpaths.clear();
+        for (int s = 0; s < numStops; s++) {
+            footpaths.insert(footpaths.end(), walks[s].begin(), walks[s].end());
+            footpath_offset[s + 1] = static_cast<int>(footpaths.size());
+        }
+
+        cout << "Loaded timetable '" << filename << "': " << getNumRoutes() << " routes, "
+             << getNumTrips() << " trips, " << footpaths.size() / 2 << " footpaths." << endl;
+        return true;
+    }
+
+    bool isLoaded() const { return !route_names.empty(); }
+};
+
+#endif // TIMETABLE_H
@@ -0,0 +1,192 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// One finished span; name and category must be string literals
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    uint64_t start_us;
+    uint64_t duration_us;
+};
+
+// Scoped-span tracing written out as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+//
+// Tracing is off unless start() is called, and a span costs one relaxed load when it is off.
+// When on, each thread appends to its own fixed-size buffer: the slot is written, then the count
+// is published with a release store, so recording takes no lock and writeJson() can read every
+// buffer while threads are still tracing. A full buffer drops further spans and counts them.
+// Buffers outlive their threads and are handed to the next new thread, so short-lived workers do
+// not each allocate one; they share a timeline row ("tid") one after another.
+class Tracer {
+private:
+    struct Buffer {
+        static const size_t CAPACITY = 1 << 15;
+
+        unique_ptr<TraceEvent[]> events;
+        atomic<size_t> count;
+        atomic<uint64_t> dropped;
+        int tid;
+        string thread_name;     // Guarded by registry_mutex
+
+        explicit Buffer(int id) : events(new TraceEvent[CAPACITY]), count(0), dropped(0), tid(id) {}
+    };
+
+    // Returns the thread's buffer to the free list when the thread exits
+    struct LocalBuffer {
+        Buffer* buffer;
+        LocalBuffer() : buffer(nullptr) {}
+        ~LocalBuffer() {
+            if (buffer) Tracer::release(buffer);
+        }
+    };
+
+    inline static atomic<bool> on{false};
+    inline static chrono::steady_clock::time_point epoch = chrono::steady_clock::now();
+    inline static string output_file;
+    inline static mutex registry_mutex;
+    inline static vector<unique_ptr<Buffer>> buffers;
+    inline static vector<Buffer*> free_buffers;
+    inline static thread_local LocalBuffer local;
+
+    static Buffer* acquire() {
+        lock_guard<mutex> lock(registry_mutex);
+        if (!free_buffers.empty()) {
+            Buffer* buffer = free_buffers.back();
+            free_buffers.pop_back();
+            return buffer;
+        }
+        buffers.push_back(make_unique<Buffer>(static_cast<int>(buffers.size()) + 1));
+        return buffers.back().get();
+    }
+
+    static void release(Buffer* buffer) {
+        lock_guard<mutex> lock(registry_mutex);
+        free_buffers.push_back(buffer);
+    }
+
+    static Buffer& threadBuffer() {
+        if (!local.buffer) local.buffer = acquire();
+        return *local.buffer;
+    }
+
+public:
+    static bool enabled() { return on.load(memory_order_relaxed); }
+
+    // Begin recording; timestamps count from here. writeJson() writes to filename at the end.
+    static void start(const string& filename = "") {
+        lock_guard<mutex> lock(registry_mutex);
+        if (!on.load()) epoch = chrono::steady_clock::now();
+        output_file = filename;
+        on.store(true);
+    }
+
+    // Start tracing if COMMUTE_TRACE names an output file; true if it did
+    static bool startFromEnvironment() {
+        const char* filename = getenv("COMMUTE_TRACE");
+        if (!filename || !*filename) return false;
+        start(filename);
+        return true;
+    }
+
+    static uint64_t nowUs() {
+        return static_cast<uint64_t>(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - epoch).count());
+    }
+
+    static void record(const char* name, const char* category, uint64_t start_us, uint64_t end_us) {
+        Buffer& buffer = threadBuffer();
+        size_t slot = buffer.count.load(memory_order_relaxed);
+        if (slot == Buffer::CAPACITY) {
+            buffer.dropped.fetch_add(1, memory_order_relaxed);
+            return;
+        }
+        buffer.events[slot] = TraceEvent{name, category, start_us, end_us - start_us};
+        buffer.count.store(slot + 1, memory_order_release);
+    }
+
+    // Label the calling thread's row in the viewer
+    static void setThreadName(const string& name) {
+        if (!enabled()) return;
+        Buffer& buffer = threadBuffer();
+        lock_guard<mutex> lock(registry_mutex);
+        buffer.thread_name = name;
+    }
+
+    // Everything recorded so far as Chrome trace-event JSON
+    static bool writeJson(const string& filename) {
+        ofstream out(filename);
+        if (!out.is_open()) {
+            cerr << "Error: Could not open trace file for writing: '" << filename << "'" << endl;
+            return false;
+        }
+        lock_guard<mutex> lock(registry_mutex);
+        uint64_t dropped = 0;
+        bool first = true;
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        for (const unique_ptr<Buffer>& buffer : buffers) {
+            if (!buffer->thread_name.empty()) {
+                out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+                    << ",\"args\":{\"name\":\"" << buffer->thread_name << "\"}}";
+                first = false;
+            }
+            size_t count = buffer->count.load(memory_order_acquire);
+            for (size_t i = 0; i < count; i++) {
+                const TraceEvent& event = buffer->events[i];
+                out << (first ? "\n" : ",\n") << "{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+                    << "\",\"ph\":\"X\",\"ts\":" << event.start_us << ",\"dur\":" << event.duration_us
+                    << ",\"pid\":1,\"tid\":" << buffer->tid << "}";
+                first = false;
+            }
+            dropped += buffer->dropped.load(memory_order_relaxed);
+        }
+        out << "\n]}\n";
+        if (dropped > 0) {
+            cerr << "Warning: " << dropped << " trace spans did not fit in their thread's buffer and were dropped." << endl;
+        }
+        return true;
+    }
+
+    // Write to the file given to start(), if tracing is on and one was given
+    static bool finish() {
+        if (!enabled() || output_file.empty()) return false;
+        bool written = writeJson(output_file);
+        if (written) cerr << "Trace written to '" << output_file << "'." << endl;
+        return written;
+    }
+};
+
+// Records the time from construction to the end of the scope as one span
+class TraceSpan {
+private:
+    const char* name;
+    const char* category;
+    uint64_t start_us;
+    bool active;
+
+public:
+    TraceSpan(const char* span_name, const char* span_category)
+        : name(span_name), category(span_category), start_us(0), active(Tracer::enabled()) {
+        if (active) start_us = Tracer::nowUs();
+    }
+
+    ~TraceSpan() {
+        if (active) Tracer::record(name, category, start_us, Tracer::nowUs());
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+#endif // TRACE_H
@@ -0,0 +1,484 @@
+// Randomized differential verification of the routing engines against brute-force oracles.
+//
+// Build: g++ -std=c++17 -O2 -pthread verify.cpp -o commute_verify
+// Run:   ./commute_verify                                  500 random maps, 10 queries each
+//        ./commute_verify --cases 5000 --max-stops 20 --seed 7 --out-dir repro
+//
+// Every case is a small random map (simple undirected graph, whole-minute weights including 0,
+// sometimes disconnected) and a set of random queries. Bellman-Ford over the road list gives the
+// reference distances and hop counts, and every engine is checked against them:
+//   Dijkstra      distance, and that its path is a real path whose roads add up to it
+//   BFS           hop count and path, and Dijkstra on the same map with unit weights agrees
+//   Pareto        fastest and fewest-stop options match the oracles, options do not dominate each other
+//   k-shortest    first route is a shortest one, routes are loopless, distinct and in weight order
+//   Alternatives  both methods start with a shortest route and return loopless routes
+//   Isochrone     exactly the stops within the limit, at their oracle distances
+//   RouteSearch   Dijkstra and BFS again, both writing into one reused PathDetails
+//   Compact       Dijkstra on copies of the map as CompactGraph and CompactFloatGraph
+// New engines get an entry in ENGINE_CHECKS.
+//
+// The first failing case is shrunk (roads removed, stops removed, weights lowered) while the same
+// engine keeps failing, and written as <out-dir>/verify_nodes.txt + verify_edges.txt with the
+// destination renumbered to University, so the menu program can load and rerun it. The exit
+// status is 1 when a failure was found.
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <random>
+#include <set>
+#include <cmath>
+#include "graphV1.h"
+#include "pareto.h"
+#include "ksp.h"
+#include "alternatives.h"
+#include "isochrone.h"
+#include "route_search.h"
+
+using namespace std;
+
+struct CaseRoad {
+    int a;
+    int b;
+    double weight;
+};
+
+struct CaseQuery {
+    int start;
+    int end;
+    double limit;   // Isochrone time limit around end, like the menu's around University
+};
+
+// One random map
+struct VerifyCase {
+    int num_stops = 0;
+    vector<CaseRoad> roads;
+};
+
+// Everything the checks need for one query
+struct QueryContext {
+    const VerifyCase& map_case;
+    const Graph& graph;
+    const Graph& unit_graph;                // Same roads, every weight 1
+    const map<pair<int, int>, double>& road_weight;
+    const CaseQuery& query;
+    vector<double> distance;                // Oracle distances from query.start
+    vector<int> hops;                       // Oracle hop counts from query.start
+};
+
+const double EPSILON = 1e-9;
+
+static bool same(double a, double b) {
+    if (a == DOUBLE_INF || b == DOUBLE_INF) return a == b;
+    return fabs(a - b) <= EPSILON * max(1.0, fabs(a));
+}
+
+static string stopName(int id) { return id == 0 ? "University" : "Stop_" + to_string(id); }
+
+static Graph buildGraph(const VerifyCase& map_case, bool unit_weights) {
+    Graph graph;
+    for (int i = 0; i < map_case.num_stops; i++) graph.addNode(i, stopName(i));
+    for (const CaseRoad& road : map_case.roads) graph.addEdge(road.a, road.b, unit_weights ? 1.0 : road.weight);
+    return graph;
+}
+
+// Bellman-Ford over the road list; hops instead of weights when unit is true
+static vector<double> bellmanFord(const VerifyCase& map_case, int source, bool unit) {
+    vector<double> distance(map_case.num_stops, DOUBLE_INF);
+    distance[source] = 0;
+    for (int round = 1; round < map_case.num_stops; round++) {
+        bool changed = false;
+        for (const CaseRoad& road : map_case.roads) {
+            double weight = unit ? 1.0 : road.weight;
+            if (distance[road.a] + weight < distance[road.b]) {
+                distance[road.b] = distance[road.a] + weight;
+                changed = true;
+            }
+            if (distance[road.b] + weight < distance[road.a]) {
+                distance[road.a] = distance[road.b] + weight;
+                changed = true;
+            }
+        }
+        if (!changed) break;
+    }
+    return distance;
+}
+
+// "" if path is a route from start to end along real roads with this weight and stop count
+static string checkPath(const QueryContext& context, const PathDetails& path, bool check_weight) {
+    const vector<int>& nodes = path.node_ids_in_path;
+    if (nodes.empty()) return "path_exists is set but the path is empty";
+    if (nodes.front() != context.query.start || nodes.back() != context.query.end) return "path does not run from start to end";
+    if (path.num_stops != static_cast<int>(nodes.size()) - 1) {
+        return "num_stops is " + to_string(path.num_stops) + " for a path of " + to_string(nodes.size()) + " stops";
+    }
+    double weight = 0;
+    for (size_t i = 1; i < nodes.size(); i++) {
+        auto road = context.road_weight.find({min(nodes[i - 1], nodes[i]), max(nodes[i - 1], nodes[i])});
+        if (road == context.road_weight.end()) {
+            return "path uses a road that does not exist: " + to_string(nodes[i - 1]) + " - " + to_string(nodes[i]);
+        }
+        weight += road->second;
+    }
+    if (check_weight && !same(weight, path.total_weight)) {
+        return "total_weight is " + to_string(path.total_weight) + " but its roads add up to " + to_string(weight);
+    }
+    return "";
+}
+
+static bool loopless(const PathDetails& path) {
+    set<int> seen(path.node_ids_in_path.begin(), path.node_ids_in_path.end());
+    return seen.size() == path.node_ids_in_path.size();
+}
+
+static string checkDijkstra(const QueryContext& context) {
+    double expected = context.distance[context.query.end];
+    PathDetails path = context.graph.Dijkstra(context.query.start, context.query.end);
+    if (path.path_exists != (expected != DOUBLE_INF)) return path.path_exists ? "found a path to an unreachable stop" : "missed a reachable stop";
+    if (!path.path_exists) return "";
+    if (!same(path.total_weight, expected)) {
+        return "total_weight is " + to_string(path.total_weight) + ", Bellman-Ford says " + to_string(expected);
+    }
+    return checkPath(context, path, true);
+}
+
+static string checkBFS(const QueryContext& context) {
+    int expected = context.hops[context.query.end];
+    PathDetails path = context.graph.BFS(context.query.start, context.query.end);
+    if (path.path_exists != (expected != -1)) return path.path_exists ? "found a path to an unreachable stop" : "missed a reachable stop";
+    if (!path.path_exists) return "";
+    if (path.num_stops != expected) {
+        return "num_stops is " + to_string(path.num_stops) + ", Bellman-Ford with unit weights says " + to_string(expected);
+    }
+    PathDetails unit = context.unit_graph.Dijkstra(context.query.start, context.query.end);
+    if (!same(unit.total_weight, path.num_stops)) {
+        return "num_stops is " + to_string(path.num_stops) + ", Dijkstra with unit weights says " + to_string(unit.total_weight);
+    }
+    return checkPath(context, path, false);
+}
+
+static string checkPareto(const QueryContext& context) {
+    ParetoSearch pareto(context.graph);
+    vector<PathDetails> options = pareto.search(context.query.start, context.query.end);
+    bool reachable = context.distance[context.query.end] != DOUBLE_INF;
+    if (options.empty() != !reachable) return options.empty() ? "no options for a reachable stop" : "options for an unreachable stop";
+    if (!reachable) return "";
+    double fastest = DOUBLE_INF;
+    int fewest = INT_INF;
+    for (const PathDetails& option : options) {
+        string problem = checkPath(context, option, true);
+        if (!problem.empty()) return problem;
+        fastest = min(fastest, option.total_weight);
+        fewest = min(fewest, option.num_stops);
+    }
+    if (!same(fastest, context.distance[context.query.end])) {
+        return "fastest option takes " + to_string(fastest) + ", Bellman-Ford says " + to_string(context.distance[context.query.end]);
+    }
+    if (fewest != context.hops[context.query.end]) {
+        return "fewest-stop option has " + to_string(fewest) + " stops, Bellman-Ford says " + to_string(context.hops[context.query.end]);
+    }
+    for (size_t i = 0; i < options.size(); i++) {
+        for (size_t j = 0; j < options.size(); j++) {
+            if (i != j && options[i].total_weight <= options[j].total_weight + EPSILON && options[i].num_stops <= options[j].num_stops &&
+                (options[i].total_weight < options[j].total_weight - EPSILON || options[i].num_stops < options[j].num_stops)) {
+                return "option " + to_string(j + 1) + " is dominated by option " + to_string(i + 1);
+            }
+        }
+    }
+    return "";
+}
+
+static string checkKShortest(const QueryContext& context) {
+    const int K = 4;
+    KShortestPaths ksp(context.graph, 2);
+    vector<PathDetails> routes = ksp.search(context.query.start, context.query.end, K);
+    bool reachable = context.distance[context.query.end] != DOUBLE_INF;
+    if (routes.empty() != !reachable) return routes.empty() ? "no routes for a reachable stop" : "routes for an unreachable stop";
+    if (!reachable) return "";
+    if (static_cast<int>(routes.size()) > K) return "returned more than k routes";
+    if (!same(routes[0].total_weight, context.distance[context.query.end])) {
+        return "first route takes " + to_string(routes[0].total_weight) + ", Bellman-Ford says " + to_string(context.distance[context.query.end]);
+    }
+    set<vector<int>> distinct;
+    for (size_t i = 0; i < routes.size(); i++) {
+        string problem = checkPath(context, routes[i], true);
+        if (!problem.empty()) return "route " + to_string(i + 1) + ": " + problem;
+        if (!loopless(routes[i])) return "route " + to_string(i + 1) + " visits a stop twice";
+        if (i > 0 && routes[i].total_weight < routes[i - 1].total_weight - EPSILON) return "routes are not in weight order";
+        if (!distinct.insert(routes[i].node_ids_in_path).second) return "route " + to_string(i + 1) + " is a duplicate";
+    }
+    return "";
+}
+
+static string checkAlternatives(const QueryContext& context) {
+    AlternativeRoutes alternatives(context.graph);
+    for (AlternativeMethod method : {ALTERNATIVES_PLATEAU, ALTERNATIVES_PENALTY}) {
+        string name = method == ALTERNATIVES_PLATEAU ? "plateau method: " : "penalty method: ";
+        vector<PathDetails> routes = alternatives.search(context.query.start, context.query.end, method);
+        bool reachable = context.distance[context.query.end] != DOUBLE_INF;
+        if (routes.empty() != !reachable) return name + (routes.empty() ? "no routes for a reachable stop" : "routes for an unreachable stop");
+        if (!reachable) continue;
+        if (!same(routes[0].total_weight, context.distance[context.query.end])) {
+            return name + "first route takes " + to_string(routes[0].total_weight) + ", Bellman-Ford says " +
+                   to_string(context.distance[context.query.end]);
+        }
+        for (size_t i = 0; i < routes.size(); i++) {
+            string problem = checkPath(context, routes[i], true);
+            if (!problem.empty()) return name + "route " + to_string(i + 1) + ": " + problem;
+            if (!loopless(routes[i])) return name + "route " + to_string(i + 1) + " visits a stop twice";
+        }
+    }
+    return "";
+}
+
+static string checkIsochrone(const QueryContext& context) {
+    IsochroneSearch isochrone(context.graph);
+    IsochroneResult result = isochrone.search(context.query.end, {context.query.limit});
+    vector<double> distance = bellmanFord(context.map_case, context.query.end, false);
+    map<int, double> reached;
+    for (size_t i = 0; i < result.node_ids.size(); i++) {
+        if (!reached.insert({result.node_ids[i], result.distances[i]}).second) return "stop " + to_string(result.node_ids[i]) + " listed twice";
+    }
+    for (int v = 0; v < context.map_case.num_stops; v++) {
+        bool within = distance[v] <= context.query.limit + EPSILON;
+        auto found = reached.find(v);
+        if (within != (found != reached.end())) {
+            return "stop " + to_string(v) + " at distance " + to_string(distance[v]) + (within ? " is missing" : " is included");
+        }
+        if (within && !same(found->second, distance[v])) {
+            return "stop " + to_string(v) + " is at " + to_string(found->second) + ", Bellman-Ford says " + to_string(distance[v]);
+        }
+    }
+    return "";
+}
+
+// BFS then Dijkstra into the same result, so anything left over from the first shows up in the second
+static string checkRouteSearch(const QueryContext& context) {
+    RouteSearch search(context.graph);
+    PathDetails route;
+    bool reachable = context.distance[context.query.end] != DOUBLE_INF;
+    if (search.BFS(context.query.start, context.query.end, route) != reachable) return "BFS: reachability disagrees with Bellman-Ford";
+    if (reachable) {
+        if (route.num_stops != context.hops[context.query.end]) {
+            return "BFS: num_stops is " + to_string(route.num_stops) + ", Bellman-Ford with unit weights says " +
+                   to_string(context.hops[context.query.end]);
+        }
+        string problem = checkPath(context, route, false);
+        if (!problem.empty()) return "BFS: " + problem;
+    }
+    if (search.Dijkstra(context.query.start, context.query.end, route) != reachable) {
+        return "Dijkstra: reachability disagrees with Bellman-Ford";
+    }
+    if (!reachable) return route.node_ids_in_path.empty() ? "" : "Dijkstra: no path, but the previous path was left in the result";
+    if (!same(route.total_weight, context.distance[context.query.end])) {
+        return "Dijkstra: total_weight is " + to_string(route.total_weight) + ", Bellman-Ford says " +
+               to_string(context.distance[context.query.end]);
+    }
+    string problem = checkPath(context, route, true);
+    return problem.empty() ? "" : "Dijkstra: " + problem;
+}
+
+// Dijkstra on a copy of the map in other ID and weight types
+template <class Id, class Weight>
+static string checkCompactDijkstra(const QueryContext& context, const string& name) {
+    BasicGraph<Id, Weight> compact;
+    if (!compact.copyFrom(context.graph)) return name + ": the map's whole-minute weights did not convert";
+    BasicRouteSearch<Id, Weight> search(compact);
+    PathDetails route;
+    bool reachable = context.distance[context.query.end] != DOUBLE_INF;
+    if (search.Dijkstra(context.query.start, context.query.end, route) != reachable) {
+        return name + ": reachability disagrees with Bellman-Ford";
+    }
+    if (!reachable) return "";
+    if (!same(route.total_weight, context.distance[context.query.end])) {
+        return name + ": total_weight is " + to_string(route.total_weight) + ", Bellman-Ford says " +
+               to_string(context.distance[context.query.end]);
+    }
+    string problem = checkPath(context, route, true);
+    return problem.empty() ? "" : name + ": " + problem;
+}
+
+static string checkCompact(const QueryContext& context) {
+    string problem = checkCompactDijkstra<uint32_t, uint32_t>(context, "CompactGraph");
+    return problem.empty() ? checkCompactDijkstra<uint32_t, float>(context, "CompactFloatGraph") : problem;
+}
+
+const vector<pair<string, function<string(const QueryContext&)>>> ENGINE_CHECKS = {
+    {"Dijkstra", checkDijkstra},
+    {"BFS", checkBFS},
+    {"Pareto", checkPareto},
+    {"k-shortest", checkKShortest},
+    {"Alternatives", checkAlternatives},
+    {"Isochrone", checkIsochrone},
+    {"RouteSearch", checkRouteSearch},
+    {"Compact", checkCompact},
+};
+
+// The first engine failing on this query and why, or an empty engine name
+static pair<string, string> runChecks(const VerifyCase& map_case, const CaseQuery& query, const string& only_engine = "") {
+    Graph graph = buildGraph(map_case, false);
+    Graph unit_graph = buildGraph(map_case, true);
+    map<pair<int, int>, double> road_weight;
+    for (const CaseRoad& road : map_case.roads) road_weight[{min(road.a, road.b), max(road.a, road.b)}] = road.weight;
+
+    QueryContext context{map_case, graph, unit_graph, road_weight, query, bellmanFord(map_case, query.start, false), {}};
+    vector<double> hop_distance = bellmanFord(map_case, query.start, true);
+    for (double hops : hop_distance) context.hops.push_back(hops == DOUBLE_INF ? -1 : static_cast<int>(hops));
+
+    for (const auto& check : ENGINE_CHECKS) {
+        if (!only_engine.empty() && check.first != only_engine) continue;
+        string problem = check.second(context);
+        if (!problem.empty()) return {check.first, problem};
+    }
+    return {"", ""};
+}
+
+static VerifyCase randomCase(mt19937& rng, int max_stops) {
+    VerifyCase map_case;
+    map_case.num_stops = uniform_int_distribution<int>(2, max(2, max_stops))(rng);
+    double density = uniform_real_distribution<double>(0.1, 0.7)(rng);
+    uniform_int_distribution<int> minutes(0, 9);
+    for (int a = 0; a < map_case.num_stops; a++) {
+        for (int b = a + 1; b < map_case.num_stops; b++) {
+            if (uniform_real_distribution<double>(0, 1)(rng) < density) map_case.roads.push_back(CaseRoad{a, b, static_cast<double>(minutes(rng))});
+        }
+    }
+    shuffle(map_case.roads.begin(), map_case.roads.end(), rng);
+    return map_case;
+}
+
+// Drop stop v, renumbering the stops after it; the query is moved along
+static VerifyCase withoutStop(const VerifyCase& map_case, int v, CaseQuery& query) {
+    VerifyCase smaller;
+    smaller.num_stops = map_case.num_stops - 1;
+    auto renumber = [v](int id) { return id > v ? id - 1 : id; };
+    for (const CaseRoad& road : map_case.roads) {
+        if (road.a != v && road.b != v) smaller.roads.push_back(CaseRoad{renumber(road.a), renumber(road.b), road.weight});
+    }
+    query.start = renumber(query.start);
+    query.end = renumber(query.end);
+    return smaller;
+}
+
+// Shrink while the same engine still fails: road chunks, then single stops, then smaller weights
+static void shrink(VerifyCase& map_case, CaseQuery& query, const string& engine) {
+    auto fails = [&engine](const VerifyCase& candidate, const CaseQuery& candidate_query) {
+        return runChecks(candidate, candidate_query, engine).first == engine;
+    };
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (size_t chunk = max<size_t>(1, map_case.roads.size() / 2); chunk >= 1; chunk /= 2) {
+            for (size_t first = 0; first < map_case.roads.size();) {
+                VerifyCase candidate = map_case;
+                candidate.roads.erase(candidate.roads.begin() + first,
+                                      candidate.roads.begin() + min(first + chunk, candidate.roads.size()));
+                if (fails(candidate, query)) {
+                    map_case = candidate;
+                    progress = true;
+                } else {
+                    first += chunk;
+                }
+            }
+            if (chunk == 1) break;
+        }
+        for (int v = map_case.num_stops - 1; v >= 0 && map_case.num_stops > 2; v--) {
+            if (v == query.start || v == query.end) continue;
+            CaseQuery candidate_query = query;
+            VerifyCase candidate = withoutStop(map_case, v, candidate_query);
+            if (fails(candidate, candidate_query)) {
+                map_case = candidate;
+                query = candidate_query;
+                progress = true;
+            }
+        }
+        for (size_t i = 0; i < map_case.roads.size(); i++) {
+            for (double lower : {0.0, 1.0, floor(map_case.roads[i].weight / 2)}) {
+                if (lower >= map_case.roads[i].weight) continue;
+                VerifyCase candidate = map_case;
+                candidate.roads[i].weight = lower;
+                if (fails(candidate, query)) {
+                    map_case = candidate;
+                    progress = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Swap stop IDs so the destination is stop 0, the menu program's fixed University, then write
+// the map in its two-file format
+static bool writeRepro(VerifyCase& map_case, CaseQuery& query, const string& directory) {
+    int destination = query.end;
+    auto relabel = [destination](int id) { return id == destination ? 0 : id == 0 ? destination : id; };
+    for (CaseRoad& road : map_case.roads) {
+        road.a = relabel(road.a);
+        road.b = relabel(road.b);
+    }
+    query.start = relabel(query.start);
+    query.end = 0;
+
+    ofstream nodes(directory + "/verify_nodes.txt"), edges(directory + "/verify_edges.txt");
+    if (!nodes.is_open() || !edges.is_open()) {
+        cerr << "Error: Could not write the repro files to '" << directory << "'" << endl;
+        return false;
+    }
+    for (int i = 0; i < map_case.num_stops; i++) nodes << i << " " << stopName(i) << "\n";
+    for (const CaseRoad& road : map_case.roads) edges << road.a << " " << road.b << " " << road.weight << "\n";
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int cases = 500, queries = 10, max_stops = 12;
+    unsigned seed = 1;
+    string out_directory = ".";
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--cases" && i + 1 < argc) {
+            cases = max(1, atoi(argv[++i]));
+        } else if (arg == "--queries" && i + 1 < argc) {
+            queries = max(1, atoi(argv[++i]));
+        } else if (arg == "--max-stops" && i + 1 < argc) {
+            max_stops = max(2, atoi(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = static_cast<unsigned>(strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--out-dir" && i + 1 < argc) {
+            out_directory = argv[++i];
+        } else {
+            cerr << "Usage: " << argv[0] << " [--cases n] [--queries n] [--max-stops n] [--seed n] [--out-dir directory]" << endl;
+            return 1;
+        }
+    }
+
+    long long checked = 0;
+    for (int c = 0; c < cases; c++) {
+        mt19937 rng(seed * 1000003u + c); // Each case can be regenerated from the seed and its number
+        VerifyCase map_case = randomCase(rng, max_stops);
+        uniform_int_distribution<int> anyStop(0, map_case.num_stops - 1);
+        for (int q = 0; q < queries; q++) {
+            CaseQuery query{anyStop(rng), anyStop(rng), static_cast<double>(uniform_int_distribution<int>(0, 20)(rng))};
+            pair<string, string> failure = runChecks(map_case, query);
+            checked++;
+            if (failure.first.empty()) continue;
+
+            cout << "FAIL case " << c << " (seed " << seed << "), " << map_case.num_stops << " stops, " << map_case.roads.size()
+                 << " roads: " << failure.first << ": " << failure.second << endl;
+            shrink(map_case, query, failure.first);
+            failure = runChecks(map_case, query, failure.first);
+            cout << "Shrunk to " << map_case.num_stops << " stops and " << map_case.roads.size() << " roads: "
+                 << failure.first << ": " << failure.second << endl;
+            if (writeRepro(map_case, query, out_directory)) {
+                cout << "Repro written to " << out_directory << "/verify_nodes.txt and " << out_directory << "/verify_edges.txt" << endl;
+            }
+            cout << "Query: from " << stopName(query.start) << " (ID " << query.start << ") to University (ID 0), isochrone limit "
+                 << query.limit << endl;
+            return 1;
+        }
+    }
+    cout << "OK: " << checked << " queries on " << cases << " random maps, every engine agreed with the oracles." << endl;
+    return 0;
+}